@@ -47,6 +47,7 @@
 #include "cy_result_mw.h"
 #include "cy_nw_helper.h"
 #include "cy_log.h"
+#include "cyabs_rtos.h"
 
 /* MQTT API headers. */
 #include "core_mqtt.h"
@@ -161,6 +162,10 @@ extern "C" {
 #define CY_RSLT_MODULE_MQTT_INVALID_CREDENTIALS                    ( CY_RSLT_MQTT_ERR_BASE + 18 )
 /** TLS handshake failed. */
 #define CY_RSLT_MODULE_MQTT_HANDSHAKE_FAILED                       ( CY_RSLT_MQTT_ERR_BASE + 19 )
+/** Publish rate limit reached; retry after the time returned by \ref cy_mqtt_get_retry_after. */
+#define CY_RSLT_MODULE_MQTT_WOULD_BLOCK                            ( CY_RSLT_MQTT_ERR_BASE + 20 )
+/** Publish discarded because its expiry time passed before it was acknowledged. */
+#define CY_RSLT_MODULE_MQTT_EXPIRED                                ( CY_RSLT_MQTT_ERR_BASE + 21 )
 
 /**
  * MQTT event type for subscribed message receive event.
@@ -189,6 +194,31 @@ extern "C" {
 #define CY_MQTT_ACK_RECEIVE_TIMEOUT_MS           ( 3000U )
 #endif
 
+/**
+ * Lower bound in milliseconds of the acknowledgment timeout derived from the measured round-trip time.
+ * Once PUBACK/PUBREC/SUBACK/UNSUBACK round trips have been measured on a connection, the library waits
+ * for the smoothed round-trip time plus four times its variation, kept between \ref CY_MQTT_ACK_TIMEOUT_MIN_MS and
+ * \ref CY_MQTT_ACK_TIMEOUT_MAX_MS, instead of \ref CY_MQTT_ACK_RECEIVE_TIMEOUT_MS. The timeout doubles after each
+ * acknowledgment timeout, up to \ref CY_MQTT_ACK_TIMEOUT_MAX_MS.
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_ACK_TIMEOUT_MIN_MS
+#define CY_MQTT_ACK_TIMEOUT_MIN_MS               ( 200U )
+#endif
+
+/**
+ * Upper bound in milliseconds of the acknowledgment timeout derived from the measured round-trip time.
+ * Refer \ref CY_MQTT_ACK_TIMEOUT_MIN_MS. 0 disables the adaptation; \ref CY_MQTT_ACK_RECEIVE_TIMEOUT_MS is then always used.
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_ACK_TIMEOUT_MAX_MS
+#define CY_MQTT_ACK_TIMEOUT_MAX_MS               ( 30000U )
+#endif
+
 /**
  * MQTT message send timeout in milliseconds.
  * MQTT library function returns to the caller immediately, if the MQTT message is sent before the timeout/wait time. Else, the function returns the failure status at the end of wait time.
@@ -222,22 +252,188 @@ extern "C" {
 #define CY_MQTT_MAX_RETRY_VALUE                  ( 3U )
 #endif
 
+/**
+ * Initial backoff in milliseconds between the attempts of the automatic reconnect. Each attempt waits a random time between
+ * half and all of the backoff, which doubles after every failed attempt up to \ref CY_MQTT_RECONNECT_BACKOFF_MAX_MS.
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_RECONNECT_BACKOFF_BASE_MS
+#define CY_MQTT_RECONNECT_BACKOFF_BASE_MS        ( 1000U )
+#endif
+
+/**
+ * Maximum backoff in milliseconds between the attempts of the automatic reconnect.
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_RECONNECT_BACKOFF_MAX_MS
+#define CY_MQTT_RECONNECT_BACKOFF_MAX_MS         ( 60000U )
+#endif
+
+/**
+ * Time in milliseconds for which the resolved address of a broker host name is reused across connection attempts.
+ * An IPv4 address is preferred; an IPv6 address is used if the host name has no IPv4 address.
+ * Once the time elapses, the host name is resolved again on the next connection attempt; if that resolution fails, the
+ * previously resolved address is used. A connection attempt that fails also forces the host name to be resolved again.
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *    For TLS connections, the host name is sent as the server name indication unless sni_host_name is set in the credentials
+ *    or the host name is an IPv4 or IPv6 address.
+ *
+ */
+#ifndef CY_MQTT_DNS_CACHE_TTL_MS
+#define CY_MQTT_DNS_CACHE_TTL_MS                 ( 300000U )
+#endif
+
 /**
  * Maximum number of MQTT instances supported.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
  */
+#ifndef CY_MQTT_MAX_HANDLE
 #define CY_MQTT_MAX_HANDLE                       ( 2U )
+#endif
 
 /**
  * Configure value of maximum number of outgoing publishes maintained in MQTT library
  * until an ack is received from the broker.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *    It must not exceed MQTT_STATE_ARRAY_MAX_COUNT configured in core_mqtt_config.h. A QoS1/QoS2 publish that fails
+ *    after an acknowledgment timeout frees its slot but keeps its MQTT_STATE_ARRAY_MAX_COUNT entry until the late
+ *    acknowledgment arrives or the next clean session, so leave headroom above the slots in use.
+ *
  */
+#ifndef CY_MQTT_MAX_OUTGOING_PUBLISHES
 #define CY_MQTT_MAX_OUTGOING_PUBLISHES           ( 1U )
+#endif
+
+/**
+ * Configure value of the number of additional outgoing publish slots reserved for high-priority publishes.
+ * Refer \ref cy_mqtt_publish_ex. A high-priority publish can use these slots and the regular slots, so it never waits for
+ * the acknowledgment of a normal-priority publish to free a slot.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *    The sum of this value and \ref CY_MQTT_MAX_OUTGOING_PUBLISHES must not exceed MQTT_STATE_ARRAY_MAX_COUNT configured in core_mqtt_config.h.
+ *
+ */
+#ifndef CY_MQTT_HIGH_PRIORITY_PUBLISHES
+#define CY_MQTT_HIGH_PRIORITY_PUBLISHES          ( 1U )
+#endif
 
 /**
  * Configure value of maximum number of outgoing subscription topics maintained in MQTT library
  * until an ack is received from the broker.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
  */
+#ifndef CY_MQTT_MAX_OUTGOING_SUBSCRIBES
 #define CY_MQTT_MAX_OUTGOING_SUBSCRIBES          ( 5U )
+#endif
+
+/**
+ * Size in bytes of the buffer used by \ref cy_mqtt_publish_batch to coalesce outgoing packets into fewer transport sends.
+ * The buffer is allocated from the heap for the duration of the call.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_BATCH_SEND_BUFFER_SIZE
+#define CY_MQTT_BATCH_SEND_BUFFER_SIZE           ( 1460U )
+#endif
+
+/**
+ * Configure value of maximum number of broker endpoints per MQTT instance. Refer \ref cy_mqtt_set_broker_endpoints.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_MAX_BROKER_ENDPOINTS
+#define CY_MQTT_MAX_BROKER_ENDPOINTS             ( 3U )
+#endif
+
+/**
+ * Configure value of maximum number of subscription topics remembered per MQTT instance for restoring
+ * the subscriptions after an automatic reconnect. Refer \ref cy_mqtt_enable_auto_reconnect.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS
+#define CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS        ( 8U )
+#endif
+
+/**
+ * Configure value of maximum number of topics per MQTT instance that can hold a message queued by \ref cy_mqtt_publish_latest.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_MAX_COALESCED_TOPICS
+#define CY_MQTT_MAX_COALESCED_TOPICS             ( 4U )
+#endif
+
+/**
+ * Configure default value of the maximum publish rate in messages per second per MQTT instance; 0 disables the limit.
+ * For example, AWS IoT Core throttles a connection above 100 publishes per second.
+ * Refer rate_limit_msgs_per_sec in \ref cy_mqtt_config_t.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_RATE_LIMIT_MSGS_PER_SEC
+#define CY_MQTT_RATE_LIMIT_MSGS_PER_SEC          ( 0U )
+#endif
+
+/**
+ * Configure default value of the maximum publish rate in payload bytes per second per MQTT instance; 0 disables the limit.
+ * For example, AWS IoT Core throttles a connection above 512 KB per second.
+ * Refer rate_limit_bytes_per_sec in \ref cy_mqtt_config_t.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_RATE_LIMIT_BYTES_PER_SEC
+#define CY_MQTT_RATE_LIMIT_BYTES_PER_SEC         ( 0U )
+#endif
+
+/**
+ * Configure value of the rate budget usage, in percent, at which \ref CY_MQTT_EVENT_TYPE_RATE_HIGH_WATERMARK is notified.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_RATE_HIGH_WATERMARK_PERCENT
+#define CY_MQTT_RATE_HIGH_WATERMARK_PERCENT      ( 80U )
+#endif
+
+/**
+ * Configure value of the rate budget usage, in percent, at which \ref CY_MQTT_EVENT_TYPE_RATE_LOW_WATERMARK is notified
+ * after a high watermark event. Must be lower than \ref CY_MQTT_RATE_HIGH_WATERMARK_PERCENT.
+ *
+ * \note
+ *    This is the default value configured in the library. This value can be modified by defining macro in application makefile.
+ *
+ */
+#ifndef CY_MQTT_RATE_LOW_WATERMARK_PERCENT
+#define CY_MQTT_RATE_LOW_WATERMARK_PERCENT       ( 50U )
+#endif
 
 /**
  * @}
@@ -271,7 +467,11 @@ typedef enum cy_mqtt_qos
 typedef enum cy_mqtt_event_type
 {
     CY_MQTT_EVENT_TYPE_SUBSCRIPTION_MESSAGE_RECEIVE = 0, /**< Message from the subscribed topic. */
-    CY_MQTT_EVENT_TYPE_DISCONNECT                   = 1  /**< Disconnected from MQTT broker. */
+    CY_MQTT_EVENT_TYPE_DISCONNECT                   = 1, /**< Disconnected from MQTT broker. */
+    CY_MQTT_EVENT_TYPE_RECONNECTED                  = 2, /**< Reconnected to MQTT broker and subscriptions restored by the automatic reconnect. Refer \ref cy_mqtt_enable_auto_reconnect. */
+    CY_MQTT_EVENT_TYPE_RATE_HIGH_WATERMARK          = 3, /**< Publish rate budget usage reached \ref CY_MQTT_RATE_HIGH_WATERMARK_PERCENT; producers should slow down. */
+    CY_MQTT_EVENT_TYPE_RATE_LOW_WATERMARK           = 4, /**< Publish rate budget usage fell to \ref CY_MQTT_RATE_LOW_WATERMARK_PERCENT after a high watermark event. */
+    CY_MQTT_EVENT_TYPE_RESUBSCRIBE_FAIL             = 5  /**< Reconnected to MQTT broker by the automatic reconnect, but one or more subscriptions could not be restored. Refer \ref cy_mqtt_enable_auto_reconnect. */
 } cy_mqtt_event_type_t;
 
 /**
@@ -283,6 +483,15 @@ typedef enum cy_mqtt_disconn_type
     CY_MQTT_DISCONN_TYPE_NETWORK_DOWN  = 1  /**< Network is disconnected */
 } cy_mqtt_disconn_type_t;
 
+/**
+ * MQTT outbound message priority.
+ */
+typedef enum cy_mqtt_priority
+{
+    CY_MQTT_PRIORITY_NORMAL = 0, /**< Normal priority, used by \ref cy_mqtt_publish. Yields to pending high-priority publishes at packet boundaries. */
+    CY_MQTT_PRIORITY_HIGH   = 1  /**< High priority, for control traffic such as alarms. */
+} cy_mqtt_priority_t;
+
 /**
  * @}
  */
@@ -333,6 +542,35 @@ typedef struct cy_mqtt_publish_info
     size_t         payload_len;  /**< Message payload length. */
 } cy_mqtt_publish_info_t;
 
+/**
+ * MQTT publish options structure used by \ref cy_mqtt_publish_ex.
+ */
+typedef struct cy_mqtt_publish_options
+{
+    cy_mqtt_priority_t  priority;   /**< Priority of the message. Refer \ref cy_mqtt_priority_t. */
+    uint32_t            expiry_ms;  /**< Time in milliseconds, counted from the call to \ref cy_mqtt_publish_ex, after which the message is discarded instead of being sent or resent. 0 means the message does not expire. */
+} cy_mqtt_publish_options_t;
+
+/**
+ * MQTT telemetry packer structure.
+ * A packer accumulates small samples for one topic into a single payload, framing each sample with a 2-byte big-endian
+ * length, and publishes the payload as one MQTT message. The structure is allocated by the application and initialized
+ * using \ref cy_mqtt_packer_init; its members are managed by the library and must not be modified.
+ */
+typedef struct cy_mqtt_packer
+{
+    cy_mqtt_t      mqtt_handle;           /**< MQTT handle used to publish the packed payload. */
+    const char     *topic;                /**< Topic on which the packed payload is published. */
+    uint16_t       topic_len;             /**< Length of the topic. */
+    cy_mqtt_qos_t  qos;                   /**< Quality of Service of the packed payload. */
+    uint8_t        *buffer;               /**< Buffer holding the packed samples. */
+    size_t         buffer_size;           /**< Size of the buffer; a flush is triggered when the next sample does not fit. */
+    size_t         used;                  /**< Number of bytes of the buffer in use. */
+    uint16_t       sample_count;          /**< Number of samples in the buffer. */
+    uint32_t       max_age_ms;            /**< Maximum time in milliseconds a sample is held before a flush; 0 to flush on size only. */
+    uint32_t       first_sample_time_ms;  /**< Time at which the oldest sample in the buffer was added. */
+} cy_mqtt_packer_t;
+
 /**
  * MQTT broker information structure.
  */
@@ -392,6 +630,173 @@ typedef struct cy_mqtt_event
  */
 typedef cy_mqtt_subscribe_info_t cy_mqtt_unsubscribe_info_t;
 
+/**
+ * Transport connect function type used by \ref cy_mqtt_transport_t.
+ * Called by \ref cy_mqtt_connect to open the link to the MQTT broker.
+ *
+ * @param transport_ctx [in]   : Transport context supplied in \ref cy_mqtt_transport_t.
+ * @param broker_info [in]     : MQTT broker information supplied to \ref cy_mqtt_create_with_transport.
+ * @param send_timeout_ms [in] : Send timeout in milliseconds.
+ * @param recv_timeout_ms [in] : Receive timeout in milliseconds.
+ *
+ * @return cy_rslt_t           : CY_RSLT_SUCCESS on success; error codes otherwise.
+ */
+typedef cy_rslt_t ( *cy_mqtt_transport_connect_t )( void *transport_ctx, cy_mqtt_broker_info_t *broker_info, uint32_t send_timeout_ms, uint32_t recv_timeout_ms );
+
+/**
+ * Transport disconnect function type used by \ref cy_mqtt_transport_t.
+ * Called by \ref cy_mqtt_disconnect to close the link to the MQTT broker.
+ *
+ * @param transport_ctx [in]   : Transport context supplied in \ref cy_mqtt_transport_t.
+ *
+ * @return cy_rslt_t           : CY_RSLT_SUCCESS on success; error codes otherwise.
+ */
+typedef cy_rslt_t ( *cy_mqtt_transport_disconnect_t )( void *transport_ctx );
+
+/**
+ * Transport send function type used by \ref cy_mqtt_transport_t.
+ *
+ * @param transport_ctx [in]   : Transport context supplied in \ref cy_mqtt_transport_t.
+ * @param buffer [in]          : Data to be sent.
+ * @param bytes_to_send [in]   : Number of bytes to be sent.
+ *
+ * @return int32_t             : Number of bytes sent; negative value if the link is broken.
+ */
+typedef int32_t ( *cy_mqtt_transport_send_t )( void *transport_ctx, const void *buffer, size_t bytes_to_send );
+
+/**
+ * Transport receive function type used by \ref cy_mqtt_transport_t.
+ * The function must not block for longer than a few milliseconds when no data is available.
+ *
+ * @param transport_ctx [in]   : Transport context supplied in \ref cy_mqtt_transport_t.
+ * @param buffer [out]         : Buffer to store the received data.
+ * @param bytes_to_recv [in]   : Maximum number of bytes to be received.
+ *
+ * @return int32_t             : Number of bytes received; 0 if no data is available; negative value if the link is broken.
+ */
+typedef int32_t ( *cy_mqtt_transport_recv_t )( void *transport_ctx, void *buffer, size_t bytes_to_recv );
+
+/**
+ * Transport wait function type used by \ref cy_mqtt_transport_t.
+ * Blocks until data is available to be received or the timeout elapses. A transport built on a readiness or completion
+ * mechanism (for example epoll or io_uring) implements this function so that the MQTT receive thread wakes up as soon as
+ * a packet arrives, instead of polling every CY_MQTT_RECEIVE_THREAD_SLEEP_MS milliseconds.
+ *
+ * @param transport_ctx [in]   : Transport context supplied in \ref cy_mqtt_transport_t.
+ * @param timeout_ms [in]      : Maximum time to wait in milliseconds.
+ *
+ * @return int32_t             : Positive value if data is available; 0 on timeout; negative value if the link is broken.
+ */
+typedef int32_t ( *cy_mqtt_transport_wait_t )( void *transport_ctx, uint32_t timeout_ms );
+
+/**
+ * MQTT transport interface structure.
+ * Supplied to \ref cy_mqtt_create_with_transport to run MQTT over a caller-provided link
+ * (for example a Unix-domain socket, a shared-memory ring, or an in-memory pipe) instead of the TCP/TLS sockets of the network stack.
+ */
+typedef struct cy_mqtt_transport
+{
+    cy_mqtt_transport_connect_t     connect;        /**< Opens the link to the broker. */
+    cy_mqtt_transport_disconnect_t  disconnect;     /**< Closes the link to the broker. */
+    cy_mqtt_transport_send_t        send;           /**< Sends data over the link. */
+    cy_mqtt_transport_recv_t        recv;           /**< Receives data from the link. */
+    cy_mqtt_transport_wait_t        wait;           /**< Waits for data on the link. Optional; set to NULL to poll the link periodically. */
+    void                            *transport_ctx; /**< Transport context passed to all the functions above. */
+} cy_mqtt_transport_t;
+
+/**
+ * Codec transform function type used by \ref cy_mqtt_codec_t to encode an outgoing payload or decode an incoming payload,
+ * for example with an LZ4 or heatshrink-class compressor.
+ * The codec decides per topic (or from a marker in the payload) whether to transform a message. To leave a payload
+ * unchanged, return CY_RSLT_SUCCESS with *out set to NULL.
+ *
+ * @param codec_ctx [in]       : Codec context supplied in \ref cy_mqtt_codec_t.
+ * @param topic [in]           : Topic name of the message.
+ * @param topic_len [in]       : Length of the topic name.
+ * @param in [in]              : Payload to transform.
+ * @param in_len [in]          : Length of the payload.
+ * @param out [out]            : Transformed payload, owned by the codec until it is passed to the release function.
+ * @param out_len [out]        : Length of the transformed payload.
+ *
+ * @return cy_rslt_t           : CY_RSLT_SUCCESS on success; an error code if the payload cannot be transformed.
+ */
+typedef cy_rslt_t ( *cy_mqtt_codec_transform_t )( void *codec_ctx, const char *topic, uint16_t topic_len,
+                                                  const char *in, size_t in_len, char **out, size_t *out_len );
+
+/**
+ * Codec release function type used by \ref cy_mqtt_codec_t.
+ * Called once the library no longer references a buffer returned by the encode or decode function.
+ *
+ * @param codec_ctx [in]       : Codec context supplied in \ref cy_mqtt_codec_t.
+ * @param buffer [in]          : Buffer returned by the encode or decode function.
+ *
+ * @return                     : void
+ */
+typedef void ( *cy_mqtt_codec_release_t )( void *codec_ctx, char *buffer );
+
+/**
+ * MQTT payload codec structure.
+ * Supplied to \ref cy_mqtt_set_codec to transform payloads between the application and the wire.
+ */
+typedef struct cy_mqtt_codec
+{
+    cy_mqtt_codec_transform_t  encode;     /**< Encodes the payloads published with \ref cy_mqtt_publish and \ref cy_mqtt_publish_batch. Optional. */
+    cy_mqtt_codec_transform_t  decode;     /**< Decodes the received payloads before they are delivered to the callbacks. Optional. */
+    cy_mqtt_codec_release_t    release;    /**< Releases the buffers returned by encode and decode. */
+    void                       *codec_ctx; /**< Codec context passed to all the functions above. */
+} cy_mqtt_codec_t;
+
+/**
+ * MQTT per-handle configuration structure.
+ * A handle created using \ref cy_mqtt_create starts with the values of the corresponding build-time macros.
+ * Refer \ref cy_mqtt_get_config and \ref cy_mqtt_set_config.
+ */
+typedef struct cy_mqtt_config
+{
+    uint32_t              ack_receive_timeout_ms;     /**< Time to wait for PUBACK/PUBREC/SUBACK/UNSUBACK until a round-trip time has been measured. Default \ref CY_MQTT_ACK_RECEIVE_TIMEOUT_MS. */
+    uint32_t              ack_timeout_min_ms;         /**< Lower bound of the adaptive acknowledgment timeout. Default \ref CY_MQTT_ACK_TIMEOUT_MIN_MS. */
+    uint32_t              ack_timeout_max_ms;         /**< Upper bound of the adaptive acknowledgment timeout; 0 disables the adaptation. Default \ref CY_MQTT_ACK_TIMEOUT_MAX_MS. */
+    uint32_t              message_send_timeout_ms;    /**< Network send timeout. Default \ref CY_MQTT_MESSAGE_SEND_TIMEOUT_MS. Applied on the next connect. */
+    uint32_t              message_receive_timeout_ms; /**< Time to wait for the rest of a partially received packet. Default \ref CY_MQTT_MESSAGE_RECEIVE_TIMEOUT_MS. */
+    uint8_t               max_retry_value;            /**< Maximum number of PUBLISH/SUBSCRIBE/UNSUBSCRIBE send attempts. Default \ref CY_MQTT_MAX_RETRY_VALUE. */
+    uint32_t              receive_thread_sleep_ms;    /**< Receive thread polling interval. Default CY_MQTT_RECEIVE_THREAD_SLEEP_MS. */
+    cy_thread_priority_t  receive_thread_priority;    /**< Receive thread priority. Default CY_MQTT_RECEIVE_THREAD_PRIORITY. Applied on the next connect. */
+    uint32_t              receive_thread_stack_size;  /**< Receive thread stack size in bytes. Default CY_MQTT_RECEIVE_THREAD_STACK_SIZE. Applied on the next connect. */
+    uint32_t              rate_limit_msgs_per_sec;    /**< Maximum publish rate in messages per second; 0 for no limit. Default \ref CY_MQTT_RATE_LIMIT_MSGS_PER_SEC. */
+    uint32_t              rate_limit_bytes_per_sec;   /**< Maximum publish rate in payload bytes per second; 0 for no limit. Default \ref CY_MQTT_RATE_LIMIT_BYTES_PER_SEC. */
+} cy_mqtt_config_t;
+
+/**
+ * MQTT statistics structure.
+ * Counters are accumulated per MQTT handle from the time of \ref cy_mqtt_create.
+ */
+typedef struct cy_mqtt_stats
+{
+    uint32_t    publish_count;                  /**< Number of messages published successfully. */
+    uint32_t    publish_fail_count;             /**< Number of publish requests that failed. */
+    uint64_t    publish_bytes;                  /**< Total payload bytes of the messages published successfully. */
+    uint32_t    receive_count;                  /**< Number of messages received on the subscribed topics. */
+    uint64_t    receive_bytes;                  /**< Total payload bytes of the messages received on the subscribed topics. */
+    uint32_t    publish_ack_count;              /**< Number of QoS1/QoS2 publishes for which the PUBACK/PUBREC was received. */
+    uint64_t    publish_ack_latency_total_ms;   /**< Sum of the publish-to-ack latencies in milliseconds. Divide by publish_ack_count for the average. */
+    uint32_t    publish_ack_latency_max_ms;     /**< Largest publish-to-ack latency observed in milliseconds. */
+    uint32_t    retry_count;                    /**< Number of PUBLISH/SUBSCRIBE/UNSUBSCRIBE packets sent again after a failed attempt. */
+    uint32_t    ack_timeout_count;              /**< Number of times an acknowledgment was not received within the acknowledgment timeout. Refer \ref cy_mqtt_config_t. */
+    uint32_t    resend_count;                   /**< Number of unacknowledged PUBLISH packets resent after an MQTT session was resumed. */
+    uint32_t    connect_retry_count;            /**< Number of network connection attempts retried with backoff in \ref cy_mqtt_connect. */
+    uint32_t    reconnect_count;                /**< Number of connections re-established by the automatic reconnect. */
+    uint32_t    dns_cache_hit_count;            /**< Number of connection attempts that reused a cached broker address. */
+    uint32_t    dns_resolve_count;              /**< Number of broker host name resolutions. */
+    uint64_t    dns_resolve_time_total_ms;      /**< Sum of the host name resolution times in milliseconds. Divide by dns_resolve_count for the average. */
+    uint32_t    coalesced_count;                /**< Number of messages queued by \ref cy_mqtt_publish_latest that were replaced by a newer value before being sent. */
+    uint32_t    rate_limited_count;             /**< Number of publishes refused with \ref CY_RSLT_MODULE_MQTT_WOULD_BLOCK by the rate limit. */
+    uint32_t    expired_count;                  /**< Number of publishes discarded because their expiry time passed. Refer \ref cy_mqtt_publish_options_t. */
+    uint32_t    rtt_sample_count;               /**< Number of round-trip times measured from PUBACK/PUBREC/SUBACK/UNSUBACK packets. */
+    uint32_t    srtt_ms;                        /**< Smoothed round-trip time of the current connection in milliseconds; 0 until measured. */
+    uint32_t    rttvar_ms;                      /**< Round-trip time variation of the current connection in milliseconds. */
+    uint32_t    ack_timeout_ms;                 /**< Acknowledgment timeout currently in use in milliseconds. Refer \ref CY_MQTT_ACK_TIMEOUT_MIN_MS. */
+} cy_mqtt_stats_t;
+
 
 /**
  * @}
@@ -466,8 +871,53 @@ cy_rslt_t cy_mqtt_create( uint8_t *buffer, uint32_t buff_len,
                           void *user_data,
                           cy_mqtt_t *mqtt_handle );
 
+/**
+ * Creates a MQTT instance that uses a caller-supplied transport instead of the TCP/TLS sockets of the network stack.
+ * The instance behaves like one created by \ref cy_mqtt_create; \ref cy_mqtt_connect and \ref cy_mqtt_disconnect
+ * open and close the link through the connect and disconnect functions of the transport.
+ * When the transport send or receive function returns a negative value while connected, the application is notified with
+ * \ref CY_MQTT_EVENT_TYPE_DISCONNECT.
+ *
+ * @param buffer [in]         : Network buffer for send and receive. Refer \ref cy_mqtt_create for details.
+ * @param buff_len [in]       : Network buffer length in bytes.
+ * @param transport [in]      : Transport interface. All function pointers except wait must be non-NULL. The structure is copied; the transport context must remain valid until the MQTT object is deleted.
+ * @param broker_info [in]    : MQTT broker information passed to the transport connect function. Refer \ref cy_mqtt_broker_info_t for details.
+ * @param event_callback [in] : Application callback function. Refer \ref cy_mqtt_create for details.
+ * @param user_data [in]      : Pointer to user data to be passed in the event callback.
+ * @param mqtt_handle [out]   : Pointer to store the MQTT handle allocated by this function on successful return.
+ *
+ * @return cy_rslt_t          : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_create_with_transport( uint8_t *buffer, uint32_t buff_len,
+                                         cy_mqtt_transport_t *transport,
+                                         cy_mqtt_broker_info_t *broker_info,
+                                         cy_mqtt_callback_t event_callback,
+                                         void *user_data,
+                                         cy_mqtt_t *mqtt_handle );
+
+/**
+ * Sets an ordered list of broker endpoints for the given MQTT instance, replacing the broker information supplied at create time.
+ *
+ * On every connection attempt, \ref cy_mqtt_connect (and the automatic reconnect) tries each endpoint once, starting with the
+ * endpoint that connected last, and backs off only after all the endpoints have failed. When one endpoint is down, the connection
+ * is established after a single connect timeout instead of the full backoff sequence.
+ * The per-endpoint connect timeout is the TCP/TLS connect timeout of the network layer, or of the transport supplied to \ref cy_mqtt_create_with_transport.
+ *
+ * \note
+ *    This function must be called while the MQTT instance is not connected. The endpoint array is copied; the host names must be
+ *    maintained until the MQTT object is deleted. The TLS credentials supplied at create time are used for all the endpoints.
+ *
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param endpoints [in]     : Array of broker endpoints in order of preference. Refer \ref cy_mqtt_broker_info_t for details.
+ * @param count [in]         : Number of endpoints in the array. Must be between 1 and \ref CY_MQTT_MAX_BROKER_ENDPOINTS.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_set_broker_endpoints( cy_mqtt_t mqtt_handle, cy_mqtt_broker_info_t *endpoints, uint8_t count );
+
 /**
  * Connects to the given MQTT broker using a secured/non-secured TCP connection and establishes MQTT client session with the broker.
+ * Returns \ref CY_RSLT_MODULE_MQTT_ALREADY_CONNECTED if the handle is already connected; call \ref cy_mqtt_disconnect first to reconnect.
  *
  * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
  * @param connect_info [in]  : MQTT connection parameters. Refer \ref cy_mqtt_connect_info_t for details.
@@ -486,6 +936,158 @@ cy_rslt_t cy_mqtt_connect( cy_mqtt_t mqtt_handle, cy_mqtt_connect_info_t *connec
  */
 cy_rslt_t cy_mqtt_publish( cy_mqtt_t mqtt_handle, cy_mqtt_publish_info_t *pub_msg );
 
+/**
+ * Publishes the MQTT message on given MQTT topic with the given options.
+ *
+ * \note
+ *    While a high-priority publish is pending, normal-priority publishes on the same handle pause at the next packet
+ *    boundary: before sending, and between the polls for their acknowledgment. Pending publishes are not aborted. A
+ *    normal-priority publish waits for at most message_send_timeout_ms (refer \ref cy_mqtt_config_t) before it continues.
+ *    Other normal-priority publishes, batches, subscribes and unsubscribes do not start during the pause. A paused publish
+ *    fails with \ref CY_RSLT_MODULE_MQTT_PUBLISH_FAIL if the connection is lost, or if a clean reconnect drops it, meanwhile.
+ *    High-priority publishes have \ref CY_MQTT_HIGH_PRIORITY_PUBLISHES outgoing slots of their own.
+ *
+ * \note
+ *    A message with a non-zero expiry_ms is checked before every send and resend, including the resend after an MQTT
+ *    session is resumed. Once expired, it is discarded and \ref CY_RSLT_MODULE_MQTT_EXPIRED is returned. A QoS2 message
+ *    that has already been sent is not discarded, because the broker may have delivered it already.
+ *
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param pub_msg [in]       : MQTT publish message information. Refer \ref cy_mqtt_publish_info_t for details.
+ * @param options [in]       : Publish options. Refer \ref cy_mqtt_publish_options_t for details. NULL selects normal priority and no expiry.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_publish_ex( cy_mqtt_t mqtt_handle, cy_mqtt_publish_info_t *pub_msg, const cy_mqtt_publish_options_t *options );
+
+/**
+ * Returns the time after which the publish last refused with \ref CY_RSLT_MODULE_MQTT_WOULD_BLOCK on the given MQTT instance
+ * fits in the rate limit.
+ *
+ * \note
+ *    When rate_limit_msgs_per_sec or rate_limit_bytes_per_sec of \ref cy_mqtt_config_t is set, each publish consumes tokens
+ *    from a bucket that refills at the configured rate and holds one second of traffic. A normal-priority publish that
+ *    does not fit returns \ref CY_RSLT_MODULE_MQTT_WOULD_BLOCK without sending; a high-priority publish is always sent.
+ *    \ref CY_MQTT_EVENT_TYPE_RATE_HIGH_WATERMARK and \ref CY_MQTT_EVENT_TYPE_RATE_LOW_WATERMARK are notified to the event
+ *    callback so that producers can slow down before publishes are refused. They are delivered after the publish
+ *    releases the library locks, so the callback may publish.
+ *
+ * @param mqtt_handle [in]     : MQTT handle created using \ref cy_mqtt_create.
+ * @param retry_after_ms [out] : Time in milliseconds to wait before retrying the refused publish.
+ *
+ * @return cy_rslt_t           : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_get_retry_after( cy_mqtt_t mqtt_handle, uint32_t *retry_after_ms );
+
+/**
+ * Publishes a batch of MQTT messages, coalescing the serialized packets into as few transport sends as possible.
+ *
+ * \note
+ *    QoS1 and QoS2 messages are sent in windows of \ref CY_MQTT_MAX_OUTGOING_PUBLISHES; the acknowledgments of a window are
+ *    collected together and the unacknowledged messages are retransmitted together. The per-message outcome is written to
+ *    the results array, which must hold count entries.
+ *    Batch messages do not expire: unlike \ref cy_mqtt_publish_ex with a non-zero expiry_ms, they are never discarded
+ *    before a send, a retry or a resend after an MQTT session is resumed. Publish time-limited messages with
+ *    \ref cy_mqtt_publish_ex.
+ *
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param msgs [in]          : Array of MQTT publish messages. Refer \ref cy_mqtt_publish_info_t for details.
+ * @param count [in]         : Number of messages in the array.
+ * @param results [out]      : Per-message result; CY_RSLT_SUCCESS, \ref CY_RSLT_MODULE_MQTT_PUBLISH_FAIL, or \ref CY_RSLT_MODULE_MQTT_WOULD_BLOCK if the rate limit refused the message.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS if all the messages are published; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_publish_batch( cy_mqtt_t mqtt_handle, cy_mqtt_publish_info_t *msgs, uint16_t count, cy_rslt_t *results );
+
+/**
+ * Queues the latest value of a topic for publishing, replacing any value of the same topic that has not been sent yet.
+ * Use it for gauge-style topics, such as a temperature or a battery level, where only the newest value matters.
+ *
+ * \note
+ *    The topic and payload are copied, and the function returns without waiting for the message to be sent. The MQTT receive
+ *    thread publishes the queued values at its next iteration, that is within receive_thread_sleep_ms (refer
+ *    \ref cy_mqtt_config_t), or after the publish in progress. At most one value per topic is queued, for up to
+ *    \ref CY_MQTT_MAX_COALESCED_TOPICS topics. Replaced values are counted in coalesced_count of \ref cy_mqtt_stats_t.
+ *    A value that fails to send is counted in publish_fail_count and is not retried.
+ *    Only QoS0 is supported, so that sending the queued values never makes the receive thread wait for an acknowledgment.
+ *
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param pub_msg [in]       : MQTT publish message information. Refer \ref cy_mqtt_publish_info_t for details.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS if the message is queued; \ref CY_RSLT_MODULE_MQTT_BADARG if qos is not
+ *                             CY_MQTT_QOS0; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_publish_latest( cy_mqtt_t mqtt_handle, cy_mqtt_publish_info_t *pub_msg );
+
+/**
+ * Initializes a telemetry packer for the given topic.
+ *
+ * \note
+ *    A packer is not thread-safe; use each packer from a single thread. The topic and the buffer must be maintained until the
+ *    packer is no longer used.
+ *
+ * @param packer [out]       : Packer to initialize. Refer \ref cy_mqtt_packer_t for details.
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param topic [in]         : Topic on which the packed payload is published.
+ * @param topic_len [in]     : Length of the topic.
+ * @param qos [in]           : Quality of Service of the packed payload.
+ * @param buffer [in]        : Buffer to hold the packed samples.
+ * @param buffer_size [in]   : Size of the buffer.
+ * @param max_age_ms [in]    : Maximum time in milliseconds a sample is held before the buffer is flushed; 0 to flush on size only.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_packer_init( cy_mqtt_packer_t *packer, cy_mqtt_t mqtt_handle, const char *topic, uint16_t topic_len,
+                               cy_mqtt_qos_t qos, uint8_t *buffer, size_t buffer_size, uint32_t max_age_ms );
+
+/**
+ * Adds a sample to the packer. The buffered samples are published first if the sample does not fit in the buffer,
+ * and after the sample is added if the oldest sample is older than max_age_ms.
+ *
+ * @param packer [in]        : Packer initialized using \ref cy_mqtt_packer_init.
+ * @param sample [in]        : Sample data.
+ * @param sample_len [in]    : Length of the sample; at most 65535 bytes and at most the buffer size minus 2.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS if the sample is added; error codes in @ref mqtt_defines otherwise. If the buffer
+ *                             is full and cannot be published, the sample is not added and the buffered samples are kept.
+ */
+cy_rslt_t cy_mqtt_packer_add( cy_mqtt_packer_t *packer, const void *sample, uint16_t sample_len );
+
+/**
+ * Publishes the samples buffered in the packer as one MQTT message. Does nothing if the packer is empty.
+ *
+ * @param packer [in]        : Packer initialized using \ref cy_mqtt_packer_init.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise. If the publish
+ *                             fails, the buffered samples are kept for the next flush.
+ */
+cy_rslt_t cy_mqtt_packer_flush( cy_mqtt_packer_t *packer );
+
+/**
+ * Publishes the buffered samples if the oldest sample is older than max_age_ms. The application calls this function
+ * periodically so that samples are not held back when no new sample is added.
+ *
+ * @param packer [in]        : Packer initialized using \ref cy_mqtt_packer_init.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_packer_poll( cy_mqtt_packer_t *packer );
+
+/**
+ * Iterates the samples of a payload packed by a \ref cy_mqtt_packer_t. Typically called from the event callback on
+ * the subscriber side.
+ *
+ * @param payload [in]       : Received payload.
+ * @param payload_len [in]   : Length of the received payload.
+ * @param offset [in, out]   : Offset of the next sample. Set to 0 before the first call; advanced on each call.
+ * @param sample [out]       : Pointer to the sample data within the payload.
+ * @param sample_len [out]   : Length of the sample.
+ *
+ * @return bool              : true if a sample is returned; false at the end of the payload. If the payload is truncated,
+ *                             false is returned with offset less than payload_len.
+ */
+bool cy_mqtt_unpack_next( const char *payload, size_t payload_len, size_t *offset, const char **sample, uint16_t *sample_len );
+
 /**
  * Subscribes for MQTT message on the given MQTT topic or list of topics.
  *
@@ -515,6 +1117,7 @@ cy_rslt_t cy_mqtt_unsubscribe( cy_mqtt_t mqtt_handle, cy_mqtt_unsubscribe_info_t
 
 /**
  * Initiates MQTT client disconnection from connected MQTT broker.
+ * If the automatic reconnect is in progress, this function stops it and waits for it to close the link before returning.
  *
  * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
  *
@@ -524,7 +1127,7 @@ cy_rslt_t cy_mqtt_disconnect( cy_mqtt_t mqtt_handle );
 
 /**
  * Deletes the given MQTT instance and frees the resources allocated for the instance by the \ref cy_mqtt_create function.
- * Before calling this API function, MQTT connection with broker must be disconnected. And the MQTT handle should not be used after delete.
+ * Before calling this API function, MQTT connection with broker must be disconnected; otherwise this function returns \ref CY_RSLT_MODULE_MQTT_DELETE_FAIL. And the MQTT handle should not be used after delete.
  *
  * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
  *
@@ -532,6 +1135,113 @@ cy_rslt_t cy_mqtt_disconnect( cy_mqtt_t mqtt_handle );
  */
 cy_rslt_t cy_mqtt_delete( cy_mqtt_t mqtt_handle );
 
+/**
+ * Gets the configuration of the given MQTT instance.
+ *
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param config [out]       : Pointer to store the configuration. Refer \ref cy_mqtt_config_t for details.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_get_config( cy_mqtt_t mqtt_handle, cy_mqtt_config_t *config );
+
+/**
+ * Sets the configuration of the given MQTT instance, so that connections for different kinds of traffic can be tuned
+ * in the same firmware. Typically, the application calls \ref cy_mqtt_get_config, changes the required members, and
+ * calls this function before \ref cy_mqtt_connect.
+ *
+ * \note
+ *    The timeouts and the retry count take effect from the next MQTT operation; the receive thread polling interval takes
+ *    effect immediately. The send timeout and the receive thread priority and stack size take effect on the next connect.
+ *
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param config [in]        : Configuration to apply. All timeouts, the retry count, and the stack size must be non-zero.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_set_config( cy_mqtt_t mqtt_handle, const cy_mqtt_config_t *config );
+
+/**
+ * Enables or disables the automatic reconnect for the given MQTT instance.
+ *
+ * When enabled, the library remembers the topics subscribed with \ref cy_mqtt_subscribe (up to \ref CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS)
+ * and forgets them on \ref cy_mqtt_unsubscribe. After \ref CY_MQTT_EVENT_TYPE_DISCONNECT is delivered, the library reconnects
+ * with the parameters of the last \ref cy_mqtt_connect instead of waiting for the application to call \ref cy_mqtt_disconnect.
+ * Attempts are spaced with exponential backoff and random jitter so that a fleet of devices does not reconnect in step;
+ * the jitter is seeded from the client identifier, so devices must use distinct client identifiers.
+ * Once connected, the subscriptions are restored in SUBSCRIBE packets of up to \ref CY_MQTT_MAX_OUTGOING_SUBSCRIBES topics,
+ * unacknowledged QoS1/QoS2 publishes are resent if the broker resumed the session, and the application is notified
+ * once with \ref CY_MQTT_EVENT_TYPE_RECONNECTED, or with \ref CY_MQTT_EVENT_TYPE_RESUBSCRIBE_FAIL if a subscription could not be restored.
+ * The backoff starts at \ref CY_MQTT_RECONNECT_BACKOFF_BASE_MS and is capped at \ref CY_MQTT_RECONNECT_BACKOFF_MAX_MS.
+ *
+ * \note
+ *    Reconnect attempts run in a thread started for the handle, so that other handles are not blocked. For TLS connections,
+ *    increase CY_MQTT_RECONNECT_THREAD_STACK_SIZE to the stack size needed for a TLS handshake.
+ *    The memory referenced by the connect information and its will message must be maintained until the MQTT object is deleted.
+ *    Calling \ref cy_mqtt_disconnect stops reconnecting. Disabling the automatic reconnect forgets the remembered subscriptions.
+ *
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param enable [in]        : true to enable the automatic reconnect; false to disable it.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_enable_auto_reconnect( cy_mqtt_t mqtt_handle, bool enable );
+
+/**
+ * Sets the payload codec of the MQTT handle. Outgoing payloads are encoded before they are published, and incoming payloads
+ * are decoded before they are delivered to the callbacks. A message whose payload fails to decode is dropped.
+ *
+ * \note
+ *    This function must be called while the MQTT instance is not connected. Pass NULL to remove the codec.
+ *
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param codec [in]         : Codec functions. The structure is copied. Refer \ref cy_mqtt_codec_t for details.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_set_codec( cy_mqtt_t mqtt_handle, const cy_mqtt_codec_t *codec );
+
+/**
+ * Registers a callback for the messages received on topics matching the given topic filter.
+ *
+ * \note
+ *    The library keeps the registered filters in a trie and routes each received message to the callbacks of all the matching
+ *    filters, in time proportional to the number of topic levels. The '+' and '#' wildcards are supported. Messages that match
+ *    no registered filter are delivered to the event callback passed to \ref cy_mqtt_create. Registering a filter does not
+ *    subscribe to it; call \ref cy_mqtt_subscribe as well. Registering the same filter again replaces its callback.
+ *
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param topic_filter [in]  : Topic filter. The filter is copied by the library.
+ * @param filter_len [in]    : Length of the topic filter.
+ * @param callback [in]      : Callback invoked with \ref CY_MQTT_EVENT_TYPE_PUBLISH_RECEIVE events for the matching messages.
+ * @param user_data [in]     : User data passed to the callback.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_register_subscription_callback( cy_mqtt_t mqtt_handle, const char *topic_filter, uint16_t filter_len,
+                                                  cy_mqtt_callback_t callback, void *user_data );
+
+/**
+ * Removes the callback registered for the given topic filter using \ref cy_mqtt_register_subscription_callback.
+ *
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param topic_filter [in]  : Topic filter used during registration.
+ * @param filter_len [in]    : Length of the topic filter.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_deregister_subscription_callback( cy_mqtt_t mqtt_handle, const char *topic_filter, uint16_t filter_len );
+
+/**
+ * Gets the statistics collected for the given MQTT instance.
+ *
+ * @param mqtt_handle [in]   : MQTT handle created using \ref cy_mqtt_create.
+ * @param stats [out]        : Pointer to store the MQTT statistics. Refer \ref cy_mqtt_stats_t for details.
+ *
+ * @return cy_rslt_t         : CY_RSLT_SUCCESS on success; error codes in @ref mqtt_defines otherwise.
+ */
+cy_rslt_t cy_mqtt_get_stats( cy_mqtt_t mqtt_handle, cy_mqtt_stats_t *stats );
+
 /**
  * One-time deinitialization function for network sockets implementation.
  * It should be called after destroying all network socket connections.
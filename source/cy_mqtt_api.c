@@ -37,6 +37,7 @@
  */
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include "cy_mqtt_api.h"
 #include "cy_utils.h"
 #include "cyabs_rtos.h"
@@ -65,10 +66,18 @@
  */
 #define CY_MQTT_RECEIVE_DATA_TIMEOUT_MS                      ( 0U )
 
+/**
+ * Size of the big-endian length prefix of each sample in a packed payload.
+ */
+#define CY_MQTT_PACKER_LENGTH_PREFIX_SIZE                    ( 2U )
+
 /**
  * Receive thread sleep time in milliseconds.
+ * Upper bound on the delay between the arrival of an unsolicited packet and its delivery to the application callback.
  */
+#ifndef CY_MQTT_RECEIVE_THREAD_SLEEP_MS
 #define CY_MQTT_RECEIVE_THREAD_SLEEP_MS                      ( 100U )
+#endif
 
 #ifndef CY_MQTT_RECEIVE_THREAD_STACK_SIZE
     #ifdef ENABLE_MQTT_LOGS
@@ -88,15 +97,45 @@
 
 #define CY_MQTT_DISCONNECT_EVENT_QUEUE_SIZE                  ( CY_MQTT_MAX_HANDLE )
 
-#ifdef ENABLE_MQTT_LOGS
-    #define CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE       ( (1024 * 1) + (1024 * 3) ) /* Additional 3kb of stack is added for enabling the prints */
+#ifndef CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE
+    #ifdef ENABLE_MQTT_LOGS
+        #define CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE   ( (1024 * 1) + (1024 * 3) ) /* Additional 3kb of stack is added for enabling the prints */
+    #else
+        #define CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE   ( 1024 * 1 )
+    #endif
 #else
-    #define CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE       ( 1024 * 1 )
+    #ifdef ENABLE_MQTT_LOGS
+        #define CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE_USER_DEBUG ( (CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE) + (1024 * 3) ) /* Additional 3kb of stack is added for enabling the prints */
+        #undef  CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE
+        #define CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE   ( CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE_USER_DEBUG )
+    #endif
 #endif
 
 #define CY_MQTT_DISCONNECT_EVENT_THREAD_PRIORITY             ( CY_RTOS_PRIORITY_NORMAL )
+
+#ifndef CY_MQTT_RECONNECT_THREAD_STACK_SIZE
+#define CY_MQTT_RECONNECT_THREAD_STACK_SIZE                  ( CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE )
+#endif
+#define CY_MQTT_RECONNECT_THREAD_PRIORITY                    ( CY_RTOS_PRIORITY_NORMAL )
 #define CY_MQTT_DISCONNECT_EVENT_QUEUE_TIMEOUT_IN_MSEC       ( 500 )
 
+/* Outgoing publish slots; the slots from CY_MQTT_MAX_OUTGOING_PUBLISHES onward are reserved for high-priority publishes. */
+#define CY_MQTT_OUTGOING_PUBLISH_SLOTS                       ( CY_MQTT_MAX_OUTGOING_PUBLISHES + CY_MQTT_HIGH_PRIORITY_PUBLISHES )
+
+/* Bits of priority_event. */
+#define CY_MQTT_PRIORITY_EVENT_NO_HIGH_PRIORITY              ( 1UL << 0 )   /* Set while no high-priority publish is pending. */
+#define CY_MQTT_PRIORITY_EVENT_NO_YIELD                      ( 1UL << 1 )   /* Set while priority_yield_active is false. */
+
+/* Size of the text form of an IPv6 address, including the terminating NUL. */
+#define CY_MQTT_IP_ADDRESS_STRING_SIZE                       ( 46U )
+
+/* Interval at which the reconnect backoff and cy_mqtt_disconnect check whether the automatic reconnect should stop or has stopped. */
+#define CY_MQTT_RECONNECT_POLL_INTERVAL_MS                   ( 100U )
+
+#if ( CY_MQTT_OUTGOING_PUBLISH_SLOTS > MQTT_STATE_ARRAY_MAX_COUNT )
+    #error "CY_MQTT_MAX_OUTGOING_PUBLISHES + CY_MQTT_HIGH_PRIORITY_PUBLISHES must not exceed MQTT_STATE_ARRAY_MAX_COUNT."
+#endif
+
 /******************************************************
  *                    Constants
  ******************************************************/
@@ -121,17 +160,101 @@ typedef struct publishpackets
 {
     uint16_t               packetid;
     MQTTPublishInfo_t      pubinfo;
+    bool                   expires;
+    uint32_t               expiry_time_ms;
 } cy_mqtt_pubpack_t;
 
 /**
- * Structure to keep the MQTT PUBLISH packet ACK information
- * for QoS1 and QoS2 publishes.
+ * Structure to remember a subscribed topic filter for restoring the
+ * subscription after an automatic reconnect.
+ */
+typedef struct tracked_subscription
+{
+    char           *topic;
+    uint16_t       topic_len;
+    cy_mqtt_qos_t  qos;
+} cy_mqtt_tracked_sub_t;
+
+/**
+ * Node of the topic filter trie used to dispatch incoming messages to per-subscription callbacks.
+ * Each node holds one topic level; the level string is allocated together with the node.
+ */
+typedef struct filter_node
+{
+    struct filter_node  *child;      /* First node of the next topic level. */
+    struct filter_node  *sibling;    /* Next node on the same topic level. */
+    cy_mqtt_callback_t  callback;    /* Callback of the filter ending at this node; NULL if none. */
+    void                *user_data;
+    uint16_t            level_len;
+    char                level[ 1 ];
+} cy_mqtt_filter_node_t;
+
+/**
+ * Structure to hold the latest unsent value of a topic published with cy_mqtt_publish_latest.
+ */
+typedef struct coalesced_message
+{
+    bool           pending;          /* A value is waiting to be sent. */
+    char           *topic;
+    uint16_t       topic_len;
+    cy_mqtt_qos_t  qos;
+    bool           retain;
+    char           *payload;
+    size_t         payload_len;
+    size_t         payload_size;     /* Allocated size of payload. */
+    bool           sending;          /* The receive thread is publishing a value of this topic. */
+    char           *sending_payload; /* Payload being published by the receive thread. */
+} cy_mqtt_coalesced_msg_t;
+
+/**
+ * Token buckets of the publish rate limit. Tokens are kept in thousandths so that the bucket
+ * refills by the configured rate per second in whole units every millisecond.
+ */
+typedef struct rate_limiter
+{
+    uint32_t  msgs_per_sec;     /* 0 if the message rate is not limited. */
+    uint32_t  bytes_per_sec;    /* 0 if the byte rate is not limited. */
+    int64_t   msg_tokens;       /* May go negative after a high-priority publish. */
+    int64_t   byte_tokens;
+    uint32_t  refill_time_ms;
+    uint32_t  retry_after_ms;   /* Wait time of the last refused publish. */
+    uint32_t  refused_count;    /* Publishes refused; reported as rate_limited_count in cy_mqtt_get_stats. */
+    bool      high_watermark;   /* High watermark notified; cleared at the low watermark. */
+} cy_mqtt_rate_limiter_t;
+
+/**
+ * Round-trip time estimate of the current connection, used to derive the acknowledgment timeout
+ * in the manner of the TCP retransmission timer (RFC 6298).
+ */
+typedef struct rtt_estimator
+{
+    bool      valid;            /* false until the first round trip of the connection is measured. */
+    uint32_t  srtt_ms;
+    uint32_t  rttvar_ms;
+    uint32_t  rto_ms;           /* Acknowledgment timeout in use, including any backoff. */
+} cy_mqtt_rtt_estimator_t;
+
+/**
+ * Structure to cache the resolved address of a broker endpoint.
+ */
+typedef struct dns_cache_entry
+{
+    bool      valid;
+    uint32_t  resolved_time_ms;
+    char      address[ CY_MQTT_IP_ADDRESS_STRING_SIZE ];   /* Dotted-decimal IPv4 or colon-separated IPv6 address. */
+} cy_mqtt_dns_cache_t;
+
+/**
+ * Outgoing PUBLISH of a batch that is waiting for its acknowledgment.
  */
-typedef struct publishpacket_ackstatus
+typedef struct batch_entry
 {
-    uint16_t      packetid;
-    bool          puback_status;
-} cy_mqtt_pub_ack_status_t;
+    uint16_t  msg_index;
+    uint8_t   slot;
+    uint16_t  packetid;
+    uint32_t  send_time_ms;
+    bool      acked;       /* Acknowledged, or dropped by a session change and no longer waited for. */
+} cy_mqtt_batch_entry_t;
 
 /*
  * MQTT handle
@@ -143,21 +266,59 @@ typedef struct mqtt_object
     bool                            mqtt_session_established;  /**< MQTT client session establishment status. */
     bool                            broker_session_present;    /**< Broker session status. */
     bool                            mqtt_conn_status;          /**< MQTT network connect status. */
+    bool                            network_connected;         /**< True while the network link to the broker is open. */
+    bool                            auto_reconnect;            /**< Automatic reconnect enabled by the application. */
+    bool                            reconnect_in_progress;     /**< True while the reconnect thread is re-establishing the connection. */
+    bool                            custom_transport;          /**< True if the caller-supplied transport is used instead of the network stack sockets. */
+    cy_mqtt_transport_t             transport;                 /**< Caller-supplied transport interface. */
+    cy_mqtt_broker_info_t           broker_info;               /**< MQTT broker info of the endpoint in use. */
+    cy_mqtt_broker_info_t           endpoints[ CY_MQTT_MAX_BROKER_ENDPOINTS ]; /**< MQTT broker endpoints in order of preference. */
+    uint8_t                         num_endpoints;             /**< Number of valid entries in endpoints. */
+    uint8_t                         last_good_endpoint;        /**< Index of the endpoint that connected last; tried first. */
+    cy_mqtt_dns_cache_t             dns_cache[ CY_MQTT_MAX_BROKER_ENDPOINTS ]; /**< Resolved addresses of the broker endpoints. */
+    cy_mqtt_connect_info_t          connect_info;              /**< MQTT connect info of the last successful connect; reused for automatic reconnect. */
+    cy_mqtt_publish_info_t          will_info;                 /**< Will message info referenced by connect_info. */
+    cy_mqtt_tracked_sub_t           tracked_subs[ CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS ]; /**< Subscriptions restored after an automatic reconnect. */
+    cy_mqtt_filter_node_t           filter_trie;               /**< Root of the topic filter trie for per-subscription callbacks. */
+    cy_mqtt_codec_t                 codec;                     /**< Payload codec; all functions NULL if not set. */
     uint8_t                         mqtt_obj_index;            /**< MQTT object index in mqtt_handle_database. */
     NetworkContext_t                network_context;           /**< MQTT Network context. */
     MQTTContext_t                   mqtt_context;              /**< MQTT context. */
+    uint8_t                         *network_buffer;           /**< Network buffer supplied to cy_mqtt_create. */
+    uint32_t                        network_buffer_len;        /**< Length of network_buffer. */
     cy_awsport_server_info_t        server_info;               /**< MQTT broker info. */
+    cy_awsport_server_info_t        connect_server_info;       /**< Broker info passed to the network layer; the host name is replaced by the cached address, if any. */
     cy_awsport_ssl_credentials_t    security;                  /**< MQTT secure connection credentials. */
+    cy_awsport_ssl_credentials_t    connect_security;          /**< Credentials passed to the network layer; the SNI host name defaults to the broker host name unless it is an IP address. */
     cy_thread_t                     recv_thread;               /**< Receive thread handle. */
+    volatile bool                   recv_thread_stop;          /**< Set to ask the receive thread to exit; the thread is joined, never terminated. */
+    cy_thread_t                     reconnect_thread;          /**< Automatic reconnect thread handle; NULL if none was started. */
+    uint32_t                        jitter_state;              /**< Random state of the reconnect jitter; 0 until seeded. */
     cy_mqtt_callback_t              mqtt_event_cb;             /**< MQTT application callback for events. */
     MQTTSubAckStatus_t              sub_ack_status[ CY_MQTT_MAX_OUTGOING_SUBSCRIBES ]; /**< MQTT SUBSCRIBE command ACK status. */
     uint8_t                         num_of_subs_in_req;        /**< Number of subscription messages in outstanding MQTT subscribe request. */
     bool                            unsub_ack_received;        /**< Status of unsubscribe acknowledgment. */
-    cy_mqtt_pub_ack_status_t        pub_ack_status;            /**< MQTT PUBLISH packetack received status. */
     uint16_t                        sent_packet_id;            /**< MQTT packet ID. */
-    cy_mqtt_pubpack_t               outgoing_pub_packets[ CY_MQTT_MAX_OUTGOING_PUBLISHES ]; /**< MQTT PUBLISH packet. */
+    cy_mqtt_pubpack_t               outgoing_pub_packets[ CY_MQTT_OUTGOING_PUBLISH_SLOTS ]; /**< MQTT PUBLISH packet. */
     cy_mutex_t                      process_mutex;             /**< Mutex for synchronizing MQTT object members. */
+    cy_mutex_t                      flow_mutex;                /**< Mutex for high_priority_pending and rate_limiter; taken without process_mutex. */
+    uint8_t                         high_priority_pending;     /**< Number of high-priority publishes in progress. */
+    bool                            priority_yield_active;     /**< True while a normal-priority publish has released process_mutex to the high-priority publishes. */
+    cy_event_t                      priority_event;            /**< Signals the end of the high-priority publishes and of a yield; refer CY_MQTT_PRIORITY_EVENT_*. */
+    uint32_t                        outgoing_discard_count;    /**< Incremented when outgoing publishes are dropped without an ack; guarded by process_mutex. */
+    cy_mqtt_rate_limiter_t          rate_limiter;              /**< Publish rate limit state. */
+    cy_mqtt_rtt_estimator_t         rtt;                       /**< Round-trip time estimate; guarded by process_mutex. */
+    cy_mutex_t                      coalesce_mutex;            /**< Mutex for coalesce_table; taken without process_mutex. */
+    cy_mqtt_coalesced_msg_t         coalesce_table[ CY_MQTT_MAX_COALESCED_TOPICS ]; /**< Latest unsent value per topic. */
+    uint32_t                        coalesced_count;           /**< Queued values replaced before being sent; guarded by coalesce_mutex. */
     void                            *user_data;                /**< User data which needs to be sent while calling registered app callback. */
+    uint8_t                         *cork_buffer;              /**< Staging buffer for outgoing packets during a batch publish; NULL otherwise. */
+    size_t                          cork_len;                  /**< Number of bytes in cork_buffer. */
+    bool                            cork_failed;               /**< A batch send failed; no further packets are written to the stream. */
+    uint16_t                        cork_msg_index;            /**< Index of the batch message being serialized. */
+    uint16_t                        cork_unflushed_from;       /**< Index of the first batch message that may not have reached the transport. */
+    cy_mqtt_config_t                config;                    /**< MQTT configuration for this handle. */
+    cy_mqtt_stats_t                 stats;                     /**< MQTT statistics for this handle; guarded by process_mutex. */
 } cy_mqtt_object_t ;
 
 /*
@@ -172,6 +333,10 @@ typedef struct mqtt_data_base
 /******************************************************
  *               Static Function Declarations
  ******************************************************/
+static void mqtt_auto_reconnect( cy_thread_arg_t arg );
+static cy_rslt_t mqtt_initialize_core_lib( MQTTContext_t *param_mqtt_context,
+                                           NetworkContext_t *param_network_context,
+                                           uint8_t *networkbuff, uint32_t buff_len );
 
 /******************************************************
  *                 Global Variables
@@ -189,7 +354,7 @@ static cy_queue_t        mqtt_disconnect_event_queue = NULL;
  ******************************************************/
 static cy_rslt_t mqtt_cleanup_outgoing_publish( cy_mqtt_object_t *mqtt_obj, uint8_t index )
 {
-    if( index >= CY_MQTT_MAX_OUTGOING_PUBLISHES )
+    if( index >= CY_MQTT_OUTGOING_PUBLISH_SLOTS )
     {
         cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n Bad arguments to mqtt_cleanup_outgoing_publish." );
         return CY_RSLT_MODULE_MQTT_BADARG;
@@ -201,6 +366,29 @@ static cy_rslt_t mqtt_cleanup_outgoing_publish( cy_mqtt_object_t *mqtt_obj, uint
 
 /*----------------------------------------------------------------------------------------------------------*/
 
+static bool mqtt_outgoing_publish_expired( cy_mqtt_object_t *mqtt_obj, uint8_t index )
+{
+    if( mqtt_obj->outgoing_pub_packets[ index ].expires == false )
+    {
+        return false;
+    }
+
+    /* Signed difference so that the comparison survives the millisecond clock wrapping around. */
+    return ( (int32_t)(Clock_GetTimeMs() - mqtt_obj->outgoing_pub_packets[ index ].expiry_time_ms) >= 0 );
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_release_outgoing_publish( cy_mqtt_object_t *mqtt_obj, uint8_t index )
+{
+    /* Gives up on a PUBLISH that was sent. Its record in the coreMQTT state engine is kept, so that a PUBACK/PUBREC
+     * arriving after the timeout is still matched and completes the record. The records left behind are skipped by
+     * the resend after a session is resumed and dropped at the next clean session. */
+    return mqtt_cleanup_outgoing_publish( mqtt_obj, index );
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
 static cy_rslt_t mqtt_cleanup_outgoing_publish_with_packet_id( cy_mqtt_object_t *mqtt_obj, uint16_t packetid )
 {
     cy_rslt_t  result = CY_RSLT_SUCCESS;
@@ -213,7 +401,7 @@ static cy_rslt_t mqtt_cleanup_outgoing_publish_with_packet_id( cy_mqtt_object_t
     }
 
     /* Clean up all saved outgoing PUBLISH packets. */
-    for( index = 0; index < CY_MQTT_MAX_OUTGOING_PUBLISHES; index++ )
+    for( index = 0; index < CY_MQTT_OUTGOING_PUBLISH_SLOTS; index++ )
     {
         if( mqtt_obj->outgoing_pub_packets[ index ].packetid == packetid )
         {
@@ -259,10 +447,11 @@ static cy_rslt_t mqtt_update_suback_status( cy_mqtt_object_t *mqtt_obj, MQTTPack
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-static cy_rslt_t mqtt_get_next_free_index_for_publish( cy_mqtt_object_t *mqtt_obj, uint8_t *pindex )
+static cy_rslt_t mqtt_get_next_free_index_for_publish( cy_mqtt_object_t *mqtt_obj, cy_mqtt_priority_t priority, uint8_t *pindex )
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
     uint8_t   index  = 0;
+    uint8_t   num_slots = CY_MQTT_MAX_OUTGOING_PUBLISHES;
     bool slot_found = false;
 
     if( (mqtt_obj == NULL) || (pindex == NULL) )
@@ -271,7 +460,13 @@ static cy_rslt_t mqtt_get_next_free_index_for_publish( cy_mqtt_object_t *mqtt_ob
         return CY_RSLT_MODULE_MQTT_BADARG;
     }
 
-    for( index = 0; index < CY_MQTT_MAX_OUTGOING_PUBLISHES; index++ )
+    /* Only high-priority publishes may use the reserved slots. */
+    if( priority == CY_MQTT_PRIORITY_HIGH )
+    {
+        num_slots = CY_MQTT_OUTGOING_PUBLISH_SLOTS;
+    }
+
+    for( index = 0; index < num_slots; index++ )
     {
         /* A free index is marked by the invalid packet ID.
          * Check if the the index has a free slot. */
@@ -308,833 +503,4172 @@ static cy_rslt_t mqtt_cleanup_outgoing_publishes( cy_mqtt_object_t *mqtt_obj )
 
     /* Clean up all outgoing PUBLISH packets. */
     ( void ) memset( mqtt_obj->outgoing_pub_packets, 0x00, sizeof( mqtt_obj->outgoing_pub_packets ) );
+    mqtt_obj->outgoing_discard_count++;
     return CY_RSLT_SUCCESS;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-static cy_rslt_t mqtt_handle_publish_resend( cy_mqtt_object_t *mqtt_obj )
+static cy_rslt_t mqtt_track_subscription( cy_mqtt_object_t *mqtt_obj, cy_mqtt_subscribe_info_t *sub_info )
 {
-    cy_rslt_t         result = CY_RSLT_SUCCESS;
-    MQTTStatus_t      mqttStatus = MQTTSuccess;
-    uint8_t           index = 0U;
-    MQTTStateCursor_t cursor = MQTT_STATE_CURSOR_INITIALIZER;
-    uint16_t          packetid_to_resend = MQTT_PACKET_ID_INVALID;
-    bool              found_packetid = false;
+    uint8_t  index = 0;
+    uint8_t  free_index = CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS;
+    char     *topic = NULL;
 
-    /* MQTT_PublishToResend() provides a packet ID of the next PUBLISH packet
-     * that should be resent. In accordance with the MQTT v3.1.1 spec,
-     * MQTT_PublishToResend() preserves the ordering of when the original
-     * PUBLISH packets were sent. The outgoing_pub_packets array is searched
-     * through for the associated packet ID. */
-    packetid_to_resend = MQTT_PublishToResend( &(mqtt_obj->mqtt_context), &cursor );
-    while( packetid_to_resend != MQTT_PACKET_ID_INVALID )
+    for( index = 0; index < CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS; index++ )
     {
-        found_packetid = false;
-
-        for( index = 0U; index < CY_MQTT_MAX_OUTGOING_PUBLISHES; index++ )
+        if( mqtt_obj->tracked_subs[ index ].topic == NULL )
         {
-            if( mqtt_obj->outgoing_pub_packets[ index ].packetid == packetid_to_resend )
+            if( free_index == CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS )
             {
-                found_packetid = true;
-                if( mqtt_obj->outgoing_pub_packets[ index ].pubinfo.qos != MQTTQoS0 )
-                {
-                    mqtt_obj->outgoing_pub_packets[ index ].pubinfo.dup = true;
-
-                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nSending duplicate PUBLISH with packet id %u.",
-                                     mqtt_obj->outgoing_pub_packets[ index ].packetid );
-                    mqttStatus = MQTT_Publish( &(mqtt_obj->mqtt_context), &(mqtt_obj->outgoing_pub_packets[ index ].pubinfo),
-                                               mqtt_obj->outgoing_pub_packets[ index ].packetid );
-                    if( mqttStatus != MQTTSuccess )
-                    {
-                        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nSending duplicate PUBLISH for packet id %u failed with status %s.",
-                                         mqtt_obj->outgoing_pub_packets[ index ].packetid, MQTT_Status_strerror( mqttStatus ) );
-                        result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
-                        break;
-                    }
-                    else
-                    {
-                        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nSent duplicate PUBLISH successfully for packet id %u.\n\n",
-                                         mqtt_obj->outgoing_pub_packets[ index ].packetid );
-                    }
-                }
-                else
-                {
-                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nResending PUBLISH packet id %u. is not required as its having QoS0\n\n",
-                                     mqtt_obj->outgoing_pub_packets[ index ].packetid );
-                }
-
+                free_index = index;
             }
+            continue;
         }
 
-        if( found_packetid == false )
+        if( (mqtt_obj->tracked_subs[ index ].topic_len == sub_info->topic_len) &&
+            (memcmp( mqtt_obj->tracked_subs[ index ].topic, sub_info->topic, sub_info->topic_len ) == 0) )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nPacket id %u requires resend, but was not found in outgoing_pub_packets.",
-                             packetid_to_resend );
-            result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
-            break;
+            /* Topic filter is already tracked; a repeated SUBSCRIBE only updates the requested QoS. */
+            mqtt_obj->tracked_subs[ index ].qos = sub_info->qos;
+            return CY_RSLT_SUCCESS;
         }
-        else
+    }
+
+    if( free_index == CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nNumber of tracked subscriptions exceeds %d. Topic %.*s will not be restored on reconnect..!\n",
+                         (int)CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS, sub_info->topic_len, sub_info->topic );
+        return CY_RSLT_MODULE_MQTT_ERROR;
+    }
+
+    topic = (char *)malloc( sub_info->topic_len );
+    if( topic == NULL )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to track subscription..!\n" );
+        return CY_RSLT_MODULE_MQTT_NOMEM;
+    }
+
+    memcpy( topic, sub_info->topic, sub_info->topic_len );
+    mqtt_obj->tracked_subs[ free_index ].topic = topic;
+    mqtt_obj->tracked_subs[ free_index ].topic_len = sub_info->topic_len;
+    mqtt_obj->tracked_subs[ free_index ].qos = sub_info->qos;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_untrack_subscription( cy_mqtt_object_t *mqtt_obj, cy_mqtt_unsubscribe_info_t *unsub_info )
+{
+    uint8_t index = 0;
+
+    for( index = 0; index < CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS; index++ )
+    {
+        if( (mqtt_obj->tracked_subs[ index ].topic != NULL) &&
+            (mqtt_obj->tracked_subs[ index ].topic_len == unsub_info->topic_len) &&
+            (memcmp( mqtt_obj->tracked_subs[ index ].topic, unsub_info->topic, unsub_info->topic_len ) == 0) )
         {
-            /* Get the next packetID to be resent. */
-            packetid_to_resend = MQTT_PublishToResend( &(mqtt_obj->mqtt_context), &cursor );
+            free( mqtt_obj->tracked_subs[ index ].topic );
+            ( void ) memset( &( mqtt_obj->tracked_subs[ index ] ), 0x00, sizeof( mqtt_obj->tracked_subs[ index ] ) );
+            break;
         }
     }
-
-    return result;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-static void mqtt_awsport_network_disconnect_callback( void *user_data )
+static void mqtt_cleanup_tracked_subscriptions( cy_mqtt_object_t *mqtt_obj )
 {
-    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    uint8_t index = 0;
 
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\n Network disconnection notification from socket layer.\n" );
+    for( index = 0; index < CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS; index++ )
+    {
+        if( mqtt_obj->tracked_subs[ index ].topic != NULL )
+        {
+            free( mqtt_obj->tracked_subs[ index ].topic );
+        }
+    }
+    ( void ) memset( mqtt_obj->tracked_subs, 0x00, sizeof( mqtt_obj->tracked_subs ) );
+}
 
-    result = cy_rtos_put_queue( &mqtt_disconnect_event_queue, (void *)&user_data, CY_MQTT_DISCONNECT_EVENT_QUEUE_TIMEOUT_IN_MSEC, false );
-    if( result != CY_RSLT_SUCCESS )
+/*----------------------------------------------------------------------------------------------------------*/
+
+static uint16_t mqtt_topic_level_len( const char *topic, uint16_t len )
+{
+    uint16_t index = 0;
+
+    while( (index < len) && (topic[ index ] != '/') )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nPushing to disconnect event queue failed with Error : [0x%X] ", (unsigned int)result );
+        index++;
     }
+    return index;
+}
 
-    return;
+/*----------------------------------------------------------------------------------------------------------*/
+
+static bool mqtt_validate_topic_filter( const char *filter, uint16_t len )
+{
+    uint16_t pos = 0;
+    uint16_t level_len = 0;
+    uint16_t index = 0;
+
+    while( true )
+    {
+        level_len = mqtt_topic_level_len( &filter[ pos ], (uint16_t)(len - pos) );
+        for( index = pos; index < (pos + level_len); index++ )
+        {
+            /* A wildcard must occupy a whole level, and '#' must be the last level. */
+            if( ((filter[ index ] == '+') || (filter[ index ] == '#')) && (level_len != 1) )
+            {
+                return false;
+            }
+            if( (filter[ index ] == '#') && ((pos + level_len) != len) )
+            {
+                return false;
+            }
+        }
+        pos = (uint16_t)(pos + level_len);
+        if( pos == len )
+        {
+            return true;
+        }
+        pos++;
+    }
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-static void mqtt_event_callback( MQTTContext_t *param_mqtt_context,
-                                 MQTTPacketInfo_t *param_packet_info,
-                                 MQTTDeserializedInfo_t *param_deserialized_info )
+static cy_mqtt_filter_node_t *mqtt_filter_find_child( cy_mqtt_filter_node_t *node, const char *level, uint16_t level_len )
 {
-    cy_rslt_t         result = CY_RSLT_SUCCESS;
-    uint16_t          packet_id;
-    cy_mqtt_object_t  *mqtt_obj = NULL;
-    cy_mqtt_t         handle = NULL;
-    uint8_t           index = 0;
-    cy_mqtt_event_t   event;
+    cy_mqtt_filter_node_t *child = node->child;
 
-    if( (param_mqtt_context == NULL) || (param_packet_info == NULL) || (param_deserialized_info == NULL) )
+    while( child != NULL )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n Bad arguments to mqtt_event_callback." );
-        return;
+        if( (child->level_len == level_len) && (memcmp( child->level, level, level_len ) == 0) )
+        {
+            return child;
+        }
+        child = child->sibling;
     }
+    return NULL;
+}
 
-    memset( &event, 0x00, sizeof(cy_mqtt_event_t) );
+/*----------------------------------------------------------------------------------------------------------*/
 
-    for( index = 0 ; index < CY_MQTT_MAX_HANDLE ; index++ )
+static cy_rslt_t mqtt_filter_insert( cy_mqtt_object_t *mqtt_obj, const char *filter, uint16_t len,
+                                     cy_mqtt_callback_t callback, void *user_data )
+{
+    cy_mqtt_filter_node_t *node = &(mqtt_obj->filter_trie);
+    cy_mqtt_filter_node_t *child = NULL;
+    uint16_t              pos = 0;
+    uint16_t              level_len = 0;
+
+    while( true )
     {
-        if( mqtt_handle_database[index].mqtt_context ==  param_mqtt_context )
+        level_len = mqtt_topic_level_len( &filter[ pos ], (uint16_t)(len - pos) );
+        child = mqtt_filter_find_child( node, &filter[ pos ], level_len );
+        if( child == NULL )
+        {
+            child = (cy_mqtt_filter_node_t *)malloc( sizeof( cy_mqtt_filter_node_t ) + level_len );
+            if( child == NULL )
+            {
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to add topic filter..!\n" );
+                return CY_RSLT_MODULE_MQTT_NOMEM;
+            }
+            memset( child, 0x00, sizeof( cy_mqtt_filter_node_t ) );
+            memcpy( child->level, &filter[ pos ], level_len );
+            child->level_len = level_len;
+            child->sibling = node->child;
+            node->child = child;
+        }
+        node = child;
+        pos = (uint16_t)(pos + level_len);
+        if( pos == len )
         {
-            handle = mqtt_handle_database[index].mqtt_handle;
             break;
         }
+        pos++;
     }
 
-    if( handle == NULL )
+    node->callback = callback;
+    node->user_data = user_data;
+    return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static bool mqtt_filter_remove( cy_mqtt_filter_node_t *node, const char *filter, uint16_t len )
+{
+    cy_mqtt_filter_node_t *child = node->child;
+    cy_mqtt_filter_node_t *prev = NULL;
+    uint16_t              level_len = mqtt_topic_level_len( filter, len );
+
+    while( (child != NULL) && ((child->level_len != level_len) || (memcmp( child->level, filter, level_len ) != 0)) )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n Invalid MQTT Context.." );
-        return;
+        prev = child;
+        child = child->sibling;
     }
 
-    mqtt_obj = ( cy_mqtt_object_t * )handle;
-    packet_id = param_deserialized_info->packetIdentifier;
+    if( child == NULL )
+    {
+        return false;
+    }
 
-    /* Handle incoming PUBLISH packets. The lower 4 bits of the PUBLISH packet
-     * type is used for the dup, QoS, and retain flags. Therefore, masking
-     * out the lower bits to check whether the packet is a PUBLISH packet. */
-    if( ( param_packet_info->type & 0xF0U ) == MQTT_PACKET_TYPE_PUBLISH )
+    if( level_len == len )
     {
-        if( param_deserialized_info->pPublishInfo != NULL )
+        if( child->callback == NULL )
         {
-            /* Handle incoming PUBLISH packets. */
-            event.type = CY_MQTT_EVENT_TYPE_PUBLISH_RECEIVE;
-            event.data.pub_msg.packet_id = packet_id;
-            event.data.pub_msg.received_message.dup =  param_deserialized_info->pPublishInfo->dup;
-            event.data.pub_msg.received_message.payload = (const char *) (param_deserialized_info->pPublishInfo->pPayload);
-            event.data.pub_msg.received_message.payload_len = param_deserialized_info->pPublishInfo->payloadLength;
+            return false;
+        }
+        child->callback = NULL;
+        child->user_data = NULL;
+    }
+    else if( mqtt_filter_remove( child, &filter[ level_len + 1 ], (uint16_t)(len - level_len - 1) ) == false )
+    {
+        return false;
+    }
 
-            if( param_deserialized_info->pPublishInfo->qos == MQTTQoS0 )
-            {
-                event.data.pub_msg.received_message.qos = CY_MQTT_QOS0;
-            }
-            if( param_deserialized_info->pPublishInfo->qos == MQTTQoS1 )
-            {
-                event.data.pub_msg.received_message.qos = CY_MQTT_QOS1;
-            }
-            if( param_deserialized_info->pPublishInfo->qos == MQTTQoS2 )
-            {
-                event.data.pub_msg.received_message.qos = CY_MQTT_QOS2;
-            }
-            event.data.pub_msg.received_message.retain = param_deserialized_info->pPublishInfo->retain;
-            event.data.pub_msg.received_message.topic = param_deserialized_info->pPublishInfo->pTopicName;
-            event.data.pub_msg.received_message.topic_len = param_deserialized_info->pPublishInfo->topicNameLength;
-            if( mqtt_obj->mqtt_event_cb != NULL )
-            {
-                mqtt_obj->mqtt_event_cb( handle, event, mqtt_obj->user_data );
-            }
+    /* Prune the nodes that no longer lead to a registered filter. */
+    if( (child->callback == NULL) && (child->child == NULL) )
+    {
+        if( prev == NULL )
+        {
+            node->child = child->sibling;
         }
         else
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n Invalid pPublishInfo.." );
-            return;
+            prev->sibling = child->sibling;
         }
+        free( child );
     }
-    else
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_filter_free( cy_mqtt_filter_node_t *node )
+{
+    cy_mqtt_filter_node_t *child = node->child;
+    cy_mqtt_filter_node_t *next = NULL;
+
+    while( child != NULL )
     {
-        /* Handle other packets. */
-        switch( param_packet_info->type )
-        {
-            case MQTT_PACKET_TYPE_SUBACK:
+        mqtt_filter_free( child );
+        next = child->sibling;
+        free( child );
+        child = next;
+    }
+    node->child = NULL;
+}
 
-                /* Make sure that the ACK packet identifier matches with the Request packet identifier. */
-                if( mqtt_obj->sent_packet_id != packet_id )
-                {
-                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nSUBACK packet identifier does not matches with Request packet identifier." );
-                }
-                else
-                {
-                    /* A SUBACK from the broker, containing the server response to our subscription request, has been received.
-                     * It contains the status code indicating server approval/rejection for the subscription to the single topic
-                     * requested. The SUBACK will be parsed to obtain the status code; this status code will be stored in the MQTT object
-                     * member 'sub_ack_status'. */
-                    result = mqtt_update_suback_status( mqtt_obj, param_packet_info );
-                    if( result != CY_RSLT_SUCCESS )
-                    {
-                        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n mqtt_update_suback_status failed..!\n" );
-                    }
-                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nSUBACK packet identifier matches with Request packet identifier." );
-                }
-                break;
-
-            case MQTT_PACKET_TYPE_UNSUBACK:
-                /* Make sure that the UNSUBACK packet identifier matches with the Request packet identifier. */
-                if( mqtt_obj->sent_packet_id != packet_id )
-                {
-                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nUNSUBACK packet identifier does not matches with Request packet identifier." );
-                    mqtt_obj->unsub_ack_received = false;
-                }
-                else
-                {
-                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nUNSUBACK packet identifier matches with Request packet identifier." );
-                    mqtt_obj->unsub_ack_received = true;
-                }
-                break;
-
-            case MQTT_PACKET_TYPE_PINGRESP:
-                if( param_deserialized_info->deserializationResult != MQTTSuccess )
-                {
-                    memset( &event, 0x00, sizeof(cy_mqtt_event_t) );
-                    event.type = CY_MQTT_EVENT_TYPE_DISCONNECT;
-                    event.data.reason = CY_MQTT_DISCONN_TYPE_BROKER_DOWN;
-                    if( mqtt_obj->mqtt_event_cb != NULL )
-                    {
-                        mqtt_obj->mqtt_event_cb( handle, event, mqtt_obj->user_data );
-                    }
-                    mqtt_obj->mqtt_session_established = false;
-                }
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPing response received." );
-                break;
+/*----------------------------------------------------------------------------------------------------------*/
 
-            case MQTT_PACKET_TYPE_PUBREC:
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPUBREC received for packet id %u.\n\n", packet_id );
-                if( param_deserialized_info->deserializationResult != MQTTSuccess )
-                {
-                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nPUBREC received with status %s.", MQTT_Status_strerror( param_deserialized_info->deserializationResult ) );
-                }
-                else
-                {
-                    if( packet_id == mqtt_obj->pub_ack_status.packetid )
-                    {
-                        mqtt_obj->pub_ack_status.puback_status = true;
-                    }
-                    else
-                    {
-                        mqtt_obj->pub_ack_status.puback_status = false;
-                    }
-                }
-                /* Clean up the PUBLISH packet when a PUBREC is received. */
-                (void)mqtt_cleanup_outgoing_publish_with_packet_id( mqtt_obj, packet_id );
-                break;
+static uint16_t mqtt_filter_dispatch( cy_mqtt_object_t *mqtt_obj, cy_mqtt_filter_node_t *node, const char *topic,
+                                      uint16_t len, bool first_level, cy_mqtt_event_t *event )
+{
+    cy_mqtt_filter_node_t *child = NULL;
+    cy_mqtt_filter_node_t *hash = NULL;
+    uint16_t              level_len = mqtt_topic_level_len( topic, len );
+    uint16_t              matched = 0;
+    bool                  wildcard_allowed;
 
-            case MQTT_PACKET_TYPE_PUBREL:
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPUBREL received for packet id %u.\n", packet_id );
-                break;
+    /* Topics starting with '$' are not matched by a wildcard in the first level. */
+    wildcard_allowed = !( first_level && (len > 0) && (topic[ 0 ] == '$') );
 
-            case MQTT_PACKET_TYPE_PUBCOMP:
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPUBCOMP received for packet id %u.\n\n", packet_id );
-                break;
+    for( child = node->child; child != NULL; child = child->sibling )
+    {
+        if( (child->level_len == 1) && (child->level[ 0 ] == '#') )
+        {
+            if( (wildcard_allowed == true) && (child->callback != NULL) )
+            {
+                child->callback( (cy_mqtt_t)mqtt_obj, *event, child->user_data );
+                matched++;
+            }
+            continue;
+        }
 
-            case MQTT_PACKET_TYPE_PUBACK:
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPUBACK received for packet id %u.\n\n", packet_id );
-                if( param_deserialized_info->deserializationResult != MQTTSuccess )
-                {
-                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nPUBACK received with status %s.", MQTT_Status_strerror( param_deserialized_info->deserializationResult ) );
-                }
-                else
-                {
-                    if( packet_id == mqtt_obj->pub_ack_status.packetid )
-                    {
-                        mqtt_obj->pub_ack_status.puback_status = true;
-                    }
-                    else
-                    {
-                        mqtt_obj->pub_ack_status.puback_status = false;
-                    }
-                }
-                /* Clean up the PUBLISH packet when a PUBACK is received. */
-                (void)mqtt_cleanup_outgoing_publish_with_packet_id( mqtt_obj, packet_id );
-                break;
+        if( ((child->level_len == 1) && (child->level[ 0 ] == '+') && (wildcard_allowed == true)) ||
+            ((child->level_len == level_len) && (memcmp( child->level, topic, level_len ) == 0)) )
+        {
+            if( level_len < len )
+            {
+                matched = (uint16_t)(matched + mqtt_filter_dispatch( mqtt_obj, child, &topic[ level_len + 1 ], (uint16_t)(len - level_len - 1), false, event ));
+                continue;
+            }
 
-            case MQTT_PACKET_TYPE_DISCONNECT:
-                /* Because this is user-initiated disconnection, no need to notify the application.*/
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nDisconnect packet received:(%02x).\n\n", param_packet_info->type );
-                break;
+            if( child->callback != NULL )
+            {
+                child->callback( (cy_mqtt_t)mqtt_obj, *event, child->user_data );
+                matched++;
+            }
 
-            /* Any other packet type is invalid. */
-            default:
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nUnknown packet type received:(%02x).\n\n", param_packet_info->type );
+            /* "a/#" also matches the parent level "a". */
+            hash = mqtt_filter_find_child( child, "#", 1 );
+            if( (hash != NULL) && (hash->callback != NULL) )
+            {
+                hash->callback( (cy_mqtt_t)mqtt_obj, *event, hash->user_data );
+                matched++;
+            }
         }
     }
+    return matched;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-static cy_rslt_t mqtt_establish_session( cy_mqtt_object_t *mqtt_obj,
-                                         MQTTConnectInfo_t *connect_info,
-                                         MQTTPublishInfo_t *will_msg,
-                                         bool create_clean_session,
-                                         bool *session_present )
+static void mqtt_rtt_reset( cy_mqtt_object_t *mqtt_obj )
 {
-    cy_rslt_t         result = CY_RSLT_SUCCESS;
-    MQTTStatus_t      mqttStatus = MQTTSuccess;
+    ( void ) memset( &(mqtt_obj->rtt), 0x00, sizeof(mqtt_obj->rtt) );
+    mqtt_obj->rtt.rto_ms = mqtt_obj->config.ack_receive_timeout_ms;
+}
 
-    /* Establish an MQTT session by sending a CONNECT packet. */
+/*----------------------------------------------------------------------------------------------------------*/
 
-    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
-    if( result != CY_RSLT_SUCCESS )
+static uint32_t mqtt_rtt_clamp( cy_mqtt_object_t *mqtt_obj, uint32_t timeout_ms )
+{
+    if( timeout_ms < mqtt_obj->config.ack_timeout_min_ms )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
-        return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+        return mqtt_obj->config.ack_timeout_min_ms;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_establish_session - Acquired Mutex %p ", mqtt_obj->process_mutex );
+    if( timeout_ms > mqtt_obj->config.ack_timeout_max_ms )
+    {
+        return mqtt_obj->config.ack_timeout_max_ms;
+    }
+    return timeout_ms;
+}
 
-    /* Send an MQTT CONNECT packet to the broker. */
-    mqttStatus = MQTT_Connect( &(mqtt_obj->mqtt_context), connect_info, will_msg, CY_MQTT_CONNACK_RECV_TIMEOUT_MS, session_present );
-    if( mqttStatus != MQTTSuccess )
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_rtt_sample( cy_mqtt_object_t *mqtt_obj, uint32_t rtt_ms )
+{
+    uint32_t delta_ms = 0;
+    uint32_t variation_ms = 0;
+
+    if( mqtt_obj->rtt.valid == false )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nConnection with MQTT broker failed with status %s.", MQTT_Status_strerror( mqttStatus ) );
+        mqtt_obj->rtt.srtt_ms = rtt_ms;
+        mqtt_obj->rtt.rttvar_ms = rtt_ms / 2;
+        mqtt_obj->rtt.valid = true;
+    }
+    else
+    {
+        delta_ms = ( mqtt_obj->rtt.srtt_ms > rtt_ms ) ? ( mqtt_obj->rtt.srtt_ms - rtt_ms ) : ( rtt_ms - mqtt_obj->rtt.srtt_ms );
+        mqtt_obj->rtt.rttvar_ms = ( (3 * mqtt_obj->rtt.rttvar_ms) + delta_ms ) / 4;
+        mqtt_obj->rtt.srtt_ms = ( (7 * mqtt_obj->rtt.srtt_ms) + rtt_ms ) / 8;
+    }
+    mqtt_obj->stats.rtt_sample_count++;
 
-        result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
-        if( result != CY_RSLT_SUCCESS )
+    /* RTO = SRTT + max( G, 4 * RTTVAR ), where the clock granularity G is the ack polling step.
+     * A new measurement also ends any backoff. */
+    if( mqtt_obj->config.ack_timeout_max_ms != 0 )
+    {
+        variation_ms = 4 * mqtt_obj->rtt.rttvar_ms;
+        if( variation_ms < CY_MQTT_SOCKET_RECEIVE_TIMEOUT_MS )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
+            variation_ms = CY_MQTT_SOCKET_RECEIVE_TIMEOUT_MS;
         }
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_establish_session - Released Mutex %p ", mqtt_obj->process_mutex );
-        return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+        mqtt_obj->rtt.rto_ms = mqtt_rtt_clamp( mqtt_obj, mqtt_obj->rtt.srtt_ms + variation_ms );
     }
-    else
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_rtt_backoff( cy_mqtt_object_t *mqtt_obj )
+{
+    /* An acknowledgment that does not arrive in time doubles the timeout for the retry, as TCP does. */
+    if( mqtt_obj->config.ack_timeout_max_ms != 0 )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nMQTT connection successfully established with broker.\n\n" );
-        mqtt_obj->mqtt_session_established = true;
+        mqtt_obj->rtt.rto_ms = mqtt_rtt_clamp( mqtt_obj, mqtt_rtt_clamp( mqtt_obj, mqtt_obj->rtt.rto_ms ) * 2 );
     }
+}
 
-    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
-    if( result != CY_RSLT_SUCCESS )
+/*----------------------------------------------------------------------------------------------------------*/
+
+static uint32_t mqtt_ack_timeout( cy_mqtt_object_t *mqtt_obj )
+{
+    if( mqtt_obj->config.ack_timeout_max_ms == 0 )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
-        return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+        return mqtt_obj->config.ack_receive_timeout_ms;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_establish_session - Released Mutex %p ", mqtt_obj->process_mutex );
-
-    return result;
+    return mqtt_obj->rtt.rto_ms;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
-int32_t mqtt_awsport_network_receive( NetworkContext_t *network_context, void *buffer, size_t bytes_recv )
+
+static void mqtt_rate_reset( cy_mqtt_object_t *mqtt_obj )
 {
-    int32_t bytes_received = 0, total_received = 0;
-    size_t entryTimeMs = 0U, exitTimeMs = 0, remainingTimeMs = 0, elapsedTimeMs = 0U;;
-    size_t bytestoread = 0;
+    cy_mqtt_rate_limiter_t *limiter = &(mqtt_obj->rate_limiter);
+
+    /* The caller must hold flow_mutex, or own the handle exclusively during create. Buckets start full. */
+    limiter->msgs_per_sec = mqtt_obj->config.rate_limit_msgs_per_sec;
+    limiter->bytes_per_sec = mqtt_obj->config.rate_limit_bytes_per_sec;
+    limiter->msg_tokens = (int64_t)limiter->msgs_per_sec * 1000;
+    limiter->byte_tokens = (int64_t)limiter->bytes_per_sec * 1000;
+    limiter->refill_time_ms = Clock_GetTimeMs();
+    limiter->retry_after_ms = 0;
+    limiter->high_watermark = false;
+}
 
-    remainingTimeMs = CY_MQTT_MESSAGE_RECEIVE_TIMEOUT_MS;
+/*----------------------------------------------------------------------------------------------------------*/
 
-    do
+static void mqtt_rate_refill( cy_mqtt_rate_limiter_t *limiter )
+{
+    uint32_t now_ms = Clock_GetTimeMs();
+    uint32_t elapsed_ms = now_ms - limiter->refill_time_ms;
+
+    /* A bucket holds one second of traffic, so a longer interval cannot add more tokens. */
+    if( elapsed_ms > 1000U )
     {
-        bytestoread = (size_t)bytes_recv - total_received;
-        entryTimeMs = Clock_GetTimeMs();
-        bytes_received = cy_awsport_network_receive( network_context, (void *)((char *)buffer + total_received), bytestoread );
-        exitTimeMs = Clock_GetTimeMs();
-        elapsedTimeMs = exitTimeMs - entryTimeMs;
-        if( bytes_received < 0 )
-        {
-            return bytes_received;
-        }
-        else if( bytes_received == 0 )
-        {
-            if( total_received == 0 )
-            {
-                /* No data in the socket, so return. */
-                break;
-            }
-        }
-        else
-        {
-            total_received = total_received + bytes_received;
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\n Total Bytes Received = %u", (unsigned int)total_received );
-            /* Reset the wait time as some data is received. */
-            elapsedTimeMs = 0;
-            remainingTimeMs = CY_MQTT_MESSAGE_RECEIVE_TIMEOUT_MS;
-        }
-        remainingTimeMs = remainingTimeMs - elapsedTimeMs;
-    } while( (total_received < bytes_recv) && (remainingTimeMs > 0) );
+        elapsed_ms = 1000U;
+    }
+    limiter->refill_time_ms = now_ms;
 
-    return total_received;
+    limiter->msg_tokens += (int64_t)elapsed_ms * limiter->msgs_per_sec;
+    if( limiter->msg_tokens > ((int64_t)limiter->msgs_per_sec * 1000) )
+    {
+        limiter->msg_tokens = (int64_t)limiter->msgs_per_sec * 1000;
+    }
+    limiter->byte_tokens += (int64_t)elapsed_ms * limiter->bytes_per_sec;
+    if( limiter->byte_tokens > ((int64_t)limiter->bytes_per_sec * 1000) )
+    {
+        limiter->byte_tokens = (int64_t)limiter->bytes_per_sec * 1000;
+    }
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-static cy_rslt_t mqtt_initialize_core_lib( MQTTContext_t *param_mqtt_context,
-                                           NetworkContext_t *param_network_context,
-                                           uint8_t *networkbuff, uint32_t buff_len )
+static uint32_t mqtt_rate_wait_ms( int64_t tokens, int64_t cost, uint32_t rate )
 {
-    cy_rslt_t            result = CY_RSLT_SUCCESS;
-    MQTTStatus_t         mqttStatus = MQTTSuccess;
-    MQTTFixedBuffer_t    networkBuffer;
-    TransportInterface_t transport;
+    int64_t needed = cost;
 
-    if( (param_mqtt_context == NULL) || (param_network_context == NULL) )
+    if( rate == 0 )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n Bad arguments to mqtt_initialize_core_lib." );
-        return CY_RSLT_MODULE_MQTT_BADARG;
+        return 0;
     }
 
-    memset( &networkBuffer, 0x00, sizeof(MQTTFixedBuffer_t) );
-    memset( &transport, 0x00, sizeof(TransportInterface_t) );
+    /* A message larger than the whole bucket passes once the bucket is full. */
+    if( needed > ((int64_t)rate * 1000) )
+    {
+        needed = (int64_t)rate * 1000;
+    }
+    if( tokens >= needed )
+    {
+        return 0;
+    }
+    return (uint32_t)( (needed - tokens + rate - 1) / rate );
+}
 
-    /* Fill in TransportInterface send and receive function pointers. */
-    transport.pNetworkContext = param_network_context;
-    transport.send = (TransportSend_t)&cy_awsport_network_send;
-    transport.recv = (TransportRecv_t)&mqtt_awsport_network_receive;
+/*----------------------------------------------------------------------------------------------------------*/
 
-    /* Fill the values for the network buffer. */
-    networkBuffer.pBuffer = networkbuff;
-    networkBuffer.size = buff_len;
+static bool mqtt_rate_check_watermarks( cy_mqtt_rate_limiter_t *limiter, cy_mqtt_event_type_t *event_type )
+{
+    int64_t usage = 0;
+    int64_t bucket_usage = 0;
 
-    /* Initialize the MQTT library. */
-    mqttStatus = MQTT_Init( param_mqtt_context, &transport, Clock_GetTimeMs,
-                            mqtt_event_callback, &networkBuffer );
-    if( mqttStatus != MQTTSuccess )
+    /* Usage is the percentage of the fuller bucket that has been consumed. */
+    if( limiter->msgs_per_sec > 0 )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n MQTT init failed with Status = %s.", MQTT_Status_strerror( mqttStatus ) );
-        result = CY_RSLT_MODULE_MQTT_INIT_FAIL;
+        usage = ( ((int64_t)limiter->msgs_per_sec * 1000 - limiter->msg_tokens) * 100 ) / ((int64_t)limiter->msgs_per_sec * 1000);
+    }
+    if( limiter->bytes_per_sec > 0 )
+    {
+        bucket_usage = ( ((int64_t)limiter->bytes_per_sec * 1000 - limiter->byte_tokens) * 100 ) / ((int64_t)limiter->bytes_per_sec * 1000);
+        if( bucket_usage > usage )
+        {
+            usage = bucket_usage;
+        }
     }
 
-    return result;
+    if( (limiter->high_watermark == false) && (usage >= CY_MQTT_RATE_HIGH_WATERMARK_PERCENT) )
+    {
+        limiter->high_watermark = true;
+        *event_type = CY_MQTT_EVENT_TYPE_RATE_HIGH_WATERMARK;
+        return true;
+    }
+    if( (limiter->high_watermark == true) && (usage <= CY_MQTT_RATE_LOW_WATERMARK_PERCENT) )
+    {
+        limiter->high_watermark = false;
+        *event_type = CY_MQTT_EVENT_TYPE_RATE_LOW_WATERMARK;
+        return true;
+    }
+    return false;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-static void mqtt_disconn_event_thread( cy_thread_arg_t arg )
+static void mqtt_rate_notify( cy_mqtt_object_t *mqtt_obj, cy_mqtt_event_type_t event_type )
 {
-    cy_rslt_t         result = CY_RSLT_SUCCESS;
-    cy_mqtt_t         handle = NULL;
-    cy_mqtt_object_t  *mqtt_obj = NULL;
-    cy_mqtt_event_t   event;
-    (void)arg;
+    cy_mqtt_event_t event;
 
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nStarting mqtt_disconn_event_thread...\n" );
+    memset( &event, 0x00, sizeof(cy_mqtt_event_t) );
+    event.type = event_type;
+    if( mqtt_obj->mqtt_event_cb != NULL )
+    {
+        mqtt_obj->mqtt_event_cb( (cy_mqtt_t)mqtt_obj, event, mqtt_obj->user_data );
+    }
+}
 
-    while( true )
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_rate_acquire( cy_mqtt_object_t *mqtt_obj, size_t payload_len, bool force,
+                                    bool *notify, cy_mqtt_event_type_t *event_type )
+{
+    cy_rslt_t              result = CY_RSLT_SUCCESS;
+    cy_mqtt_rate_limiter_t *limiter = &(mqtt_obj->rate_limiter);
+    uint32_t               wait_ms = 0;
+    uint32_t               byte_wait_ms = 0;
+
+    /* A crossed watermark is returned to the caller, which notifies the application once it holds no mutex,
+     * so that the event callback can publish. */
+    *notify = false;
+    result = cy_rtos_get_mutex( &(mqtt_obj->flow_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
     {
-        result = cy_rtos_get_queue( &mqtt_disconnect_event_queue, (void *)&handle, CY_RTOS_NEVER_TIMEOUT, false );
-        if( CY_RSLT_SUCCESS != result )
-        {
-            continue;
-        }
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->flow_mutex, (unsigned int)result );
+        return result;
+    }
 
-        memset( &event, 0x00, sizeof(cy_mqtt_event_t) );
-        event.type = CY_MQTT_EVENT_TYPE_DISCONNECT;
+    if( (limiter->msgs_per_sec > 0) || (limiter->bytes_per_sec > 0) )
+    {
+        mqtt_rate_refill( limiter );
 
-        if( handle == NULL )
+        if( force == false )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid mqtt handle...!\n" );
-        }
-        else
-        {
-            mqtt_obj = (cy_mqtt_object_t *)handle;
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_awsport_network_disconnect_callback - Acquiring Mutex %p ", mqtt_obj->process_mutex );
-            result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
-            if( result != CY_RSLT_SUCCESS )
+            wait_ms = mqtt_rate_wait_ms( limiter->msg_tokens, 1000, limiter->msgs_per_sec );
+            byte_wait_ms = mqtt_rate_wait_ms( limiter->byte_tokens, (int64_t)payload_len * 1000, limiter->bytes_per_sec );
+            if( byte_wait_ms > wait_ms )
             {
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
-                continue;
+                wait_ms = byte_wait_ms;
             }
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_awsport_network_disconnect_callback - Acquired Mutex %p ", mqtt_obj->process_mutex );
+        }
 
-            if( mqtt_obj->mqtt_session_established == true )
+        if( wait_ms > 0 )
+        {
+            limiter->retry_after_ms = wait_ms;
+            limiter->refused_count++;
+            result = CY_RSLT_MODULE_MQTT_WOULD_BLOCK;
+        }
+        else
+        {
+            if( limiter->msgs_per_sec > 0 )
             {
-                event.data.reason = CY_MQTT_DISCONN_TYPE_NETWORK_DOWN;
-                if( mqtt_obj->mqtt_event_cb != NULL )
-                {
-                    mqtt_obj->mqtt_event_cb( (cy_mqtt_t)mqtt_obj, event, mqtt_obj->user_data );
-                }
-                mqtt_obj->mqtt_session_established = false;
+                limiter->msg_tokens -= 1000;
             }
-
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_awsport_network_disconnect_callback - Releasing Mutex %p ", mqtt_obj->process_mutex );
-            result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
-            if( result != CY_RSLT_SUCCESS )
+            if( limiter->bytes_per_sec > 0 )
             {
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
+                limiter->byte_tokens -= (int64_t)payload_len * 1000;
             }
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_awsport_network_disconnect_callback - Released Mutex %p ", mqtt_obj->process_mutex );
         }
+        *notify = mqtt_rate_check_watermarks( limiter, event_type );
     }
+
+    (void)cy_rtos_set_mutex( &(mqtt_obj->flow_mutex) );
+
+    return result;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-static void mqtt_receive_thread( cy_thread_arg_t arg )
+static void mqtt_rate_poll( cy_mqtt_object_t *mqtt_obj )
 {
-    cy_rslt_t         result = CY_RSLT_SUCCESS;
-    cy_mqtt_object_t  *mqtt_obj = NULL;
-    MQTTStatus_t      mqtt_status = MQTTSuccess;
-    cy_mqtt_event_t   event;
-    bool              connect_status = true;
+    cy_mqtt_rate_limiter_t *limiter = &(mqtt_obj->rate_limiter);
+    cy_mqtt_event_type_t   event_type = CY_MQTT_EVENT_TYPE_RATE_LOW_WATERMARK;
+    bool                   notify = false;
 
-    mqtt_obj = (cy_mqtt_object_t *)arg;
+    if( cy_rtos_get_mutex( &(mqtt_obj->flow_mutex), CY_RTOS_NEVER_TIMEOUT ) != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed..! ", mqtt_obj->flow_mutex );
+        return;
+    }
 
-    if( (mqtt_obj == NULL) || (mqtt_obj->mqtt_obj_initialized == false) )
+    /* Nothing to refill towards the low watermark unless the high watermark was notified. */
+    if( limiter->high_watermark == false )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        (void)cy_rtos_set_mutex( &(mqtt_obj->flow_mutex) );
         return;
     }
 
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nStarting MQTT Receive thread for MQTT handle : %p \n", (cy_mqtt_t)mqtt_obj );
+    mqtt_rate_refill( limiter );
+    notify = mqtt_rate_check_watermarks( limiter, &event_type );
+    (void)cy_rtos_set_mutex( &(mqtt_obj->flow_mutex) );
 
-    while( true )
+    if( notify == true )
     {
-        result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+        mqtt_rate_notify( mqtt_obj, event_type );
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_cleanup_coalesce_table( cy_mqtt_object_t *mqtt_obj )
+{
+    uint8_t index = 0;
+
+    for( index = 0; index < CY_MQTT_MAX_COALESCED_TOPICS; index++ )
+    {
+        free( mqtt_obj->coalesce_table[ index ].topic );
+        free( mqtt_obj->coalesce_table[ index ].payload );
+        free( mqtt_obj->coalesce_table[ index ].sending_payload );
+    }
+    ( void ) memset( mqtt_obj->coalesce_table, 0x00, sizeof( mqtt_obj->coalesce_table ) );
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_mqtt_coalesced_msg_t *mqtt_find_coalesce_entry( cy_mqtt_object_t *mqtt_obj, const char *topic, uint16_t topic_len )
+{
+    cy_mqtt_coalesced_msg_t *entry = NULL;
+    cy_mqtt_coalesced_msg_t *free_entry = NULL;
+    cy_mqtt_coalesced_msg_t *idle_entry = NULL;
+    uint8_t                 index = 0;
+
+    /* The caller must hold coalesce_mutex. */
+    for( index = 0; index < CY_MQTT_MAX_COALESCED_TOPICS; index++ )
+    {
+        entry = &(mqtt_obj->coalesce_table[ index ]);
+        if( entry->topic == NULL )
+        {
+            if( free_entry == NULL )
+            {
+                free_entry = entry;
+            }
+        }
+        else if( (entry->topic_len == topic_len) && (memcmp( entry->topic, topic, topic_len ) == 0) )
+        {
+            return entry;
+        }
+        else if( (entry->pending == false) && (entry->sending == false) && (idle_entry == NULL) )
+        {
+            idle_entry = entry;
+        }
+    }
+
+    /* Prefer an unused entry; otherwise take over the entry of a topic that has nothing queued. */
+    return ( (free_entry != NULL) ? free_entry : idle_entry );
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_drain_coalesce_table( cy_mqtt_object_t *mqtt_obj )
+{
+    cy_rslt_t               result = CY_RSLT_SUCCESS;
+    cy_rslt_t               publish_result = CY_RSLT_SUCCESS;
+    cy_mqtt_coalesced_msg_t *entry = NULL;
+    cy_mqtt_publish_info_t  msg;
+    uint8_t                 index = 0;
+
+    /* Called by the receive thread without process_mutex; cy_mqtt_publish_ex takes it. The values are QoS0, so a publish
+     * does not wait for an ack and holds up incoming packets for one send at most. The receive thread is only stopped
+     * between two publishes, so no entry is left marked as sending. */
+    for( index = 0; (index < CY_MQTT_MAX_COALESCED_TOPICS) && (mqtt_obj->recv_thread_stop == false); index++ )
+    {
+        entry = &(mqtt_obj->coalesce_table[ index ]);
+
+        result = cy_rtos_get_mutex( &(mqtt_obj->coalesce_mutex), CY_RTOS_NEVER_TIMEOUT );
         if( result != CY_RSLT_SUCCESS )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
-            break;
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->coalesce_mutex, (unsigned int)result );
+            return;
+        }
+        if( entry->pending == false )
+        {
+            (void)cy_rtos_set_mutex( &(mqtt_obj->coalesce_mutex) );
+            continue;
         }
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_receive_thread - Acquired Mutex %p ", mqtt_obj->process_mutex );
 
-        connect_status = mqtt_obj->mqtt_session_established;
-        if( connect_status )
+        /* Take the payload out of the entry so that a newer value can be queued while this one is sent. */
+        memset( &msg, 0x00, sizeof( cy_mqtt_publish_info_t ) );
+        msg.qos = entry->qos;
+        msg.retain = entry->retain;
+        msg.topic = entry->topic;
+        msg.topic_len = entry->topic_len;
+        msg.payload = entry->payload;
+        msg.payload_len = entry->payload_len;
+        entry->sending = true;
+        entry->sending_payload = entry->payload;
+        entry->payload = NULL;
+        entry->payload_size = 0;
+        entry->pending = false;
+
+        (void)cy_rtos_set_mutex( &(mqtt_obj->coalesce_mutex) );
+
+        publish_result = cy_mqtt_publish_ex( (cy_mqtt_t)mqtt_obj, &msg, NULL );
+
+        result = cy_rtos_get_mutex( &(mqtt_obj->coalesce_mutex), CY_RTOS_NEVER_TIMEOUT );
+        if( result != CY_RSLT_SUCCESS )
         {
-            mqtt_status = MQTT_ProcessLoop( &(mqtt_obj->mqtt_context), CY_MQTT_RECEIVE_DATA_TIMEOUT_MS );
-            if( mqtt_status != MQTTSuccess )
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->coalesce_mutex, (unsigned int)result );
+            return;
+        }
+        if( (publish_result == CY_RSLT_MODULE_MQTT_WOULD_BLOCK) && (entry->pending == false) )
+        {
+            /* Requeue the value refused by the rate limit unless a newer one has replaced it. */
+            free( entry->payload );
+            entry->payload = entry->sending_payload;
+            entry->payload_size = msg.payload_len;
+            entry->pending = true;
+            entry->sending_payload = NULL;
+        }
+        free( entry->sending_payload );
+        entry->sending_payload = NULL;
+        entry->sending = false;
+        (void)cy_rtos_set_mutex( &(mqtt_obj->coalesce_mutex) );
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_handle_publish_resend( cy_mqtt_object_t *mqtt_obj )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    MQTTStatus_t      mqttStatus = MQTTSuccess;
+    uint8_t           index = 0U;
+    MQTTStateCursor_t cursor = MQTT_STATE_CURSOR_INITIALIZER;
+    uint16_t          packetid_to_resend = MQTT_PACKET_ID_INVALID;
+    bool              found_packetid = false;
+    bool              expired[ CY_MQTT_OUTGOING_PUBLISH_SLOTS ] = { false };
+
+    /* MQTT_PublishToResend() provides a packet ID of the next PUBLISH packet
+     * that should be resent. In accordance with the MQTT v3.1.1 spec,
+     * MQTT_PublishToResend() preserves the ordering of when the original
+     * PUBLISH packets were sent. The outgoing_pub_packets array is searched
+     * through for the associated packet ID. */
+    packetid_to_resend = MQTT_PublishToResend( &(mqtt_obj->mqtt_context), &cursor );
+    while( packetid_to_resend != MQTT_PACKET_ID_INVALID )
+    {
+        found_packetid = false;
+
+        for( index = 0U; index < CY_MQTT_OUTGOING_PUBLISH_SLOTS; index++ )
+        {
+            if( mqtt_obj->outgoing_pub_packets[ index ].packetid == packetid_to_resend )
             {
-                if( (mqtt_status == MQTTRecvFailed)  || (mqtt_status == MQTTSendFailed) ||
-                    (mqtt_status == MQTTBadResponse) || (mqtt_status == MQTTKeepAliveTimeout) ||
-                    (mqtt_status == MQTTIllegalState ) )
+                found_packetid = true;
+                if( (mqtt_obj->outgoing_pub_packets[ index ].pubinfo.qos == MQTTQoS1) &&
+                    (mqtt_outgoing_publish_expired( mqtt_obj, index ) == true) )
                 {
-                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nmqtt_receive_thread MQTT_ProcessLoop failed with status %s \n", MQTT_Status_strerror(mqtt_status) );
-                    memset( &event, 0x00, sizeof(cy_mqtt_event_t) );
+                    /* Released once the resend cursor is no longer in use. */
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nDiscarding expired PUBLISH with packet id %u.",
+                                     mqtt_obj->outgoing_pub_packets[ index ].packetid );
+                    expired[ index ] = true;
+                }
+                else if( mqtt_obj->outgoing_pub_packets[ index ].pubinfo.qos != MQTTQoS0 )
+                {
+                    mqtt_obj->outgoing_pub_packets[ index ].pubinfo.dup = true;
 
-                    if( mqtt_status == MQTTKeepAliveTimeout )
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nSending duplicate PUBLISH with packet id %u.",
+                                     mqtt_obj->outgoing_pub_packets[ index ].packetid );
+                    mqttStatus = MQTT_Publish( &(mqtt_obj->mqtt_context), &(mqtt_obj->outgoing_pub_packets[ index ].pubinfo),
+                                               mqtt_obj->outgoing_pub_packets[ index ].packetid );
+                    if( mqttStatus != MQTTSuccess )
                     {
-                        event.type = CY_MQTT_EVENT_TYPE_DISCONNECT;
-                        event.data.reason = CY_MQTT_DISCONN_TYPE_BROKER_DOWN;
-                        if( mqtt_obj->mqtt_event_cb != NULL )
-                        {
-                            mqtt_obj->mqtt_event_cb( (cy_mqtt_t)mqtt_obj, event, mqtt_obj->user_data );
-                        }
-                        mqtt_obj->mqtt_session_established = false;
+                        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nSending duplicate PUBLISH for packet id %u failed with status %s.",
+                                         mqtt_obj->outgoing_pub_packets[ index ].packetid, MQTT_Status_strerror( mqttStatus ) );
+                        result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+                        break;
+                    }
+                    else
+                    {
+                        mqtt_obj->stats.resend_count++;
+                        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nSent duplicate PUBLISH successfully for packet id %u.\n\n",
+                                         mqtt_obj->outgoing_pub_packets[ index ].packetid );
                     }
                 }
+                else
+                {
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nResending PUBLISH packet id %u. is not required as its having QoS0\n\n",
+                                     mqtt_obj->outgoing_pub_packets[ index ].packetid );
+                }
+
             }
         }
 
-        result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
-        if( result != CY_RSLT_SUCCESS )
+        if( found_packetid == false )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
+            /* A publish given up on after an ack timeout; its message is no longer available to resend. */
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPacket id %u was given up on and is not resent.",
+                             packetid_to_resend );
         }
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_receive_thread - Released Mutex %p ", mqtt_obj->process_mutex );
 
-        cy_rtos_delay_milliseconds( CY_MQTT_RECEIVE_THREAD_SLEEP_MS );
+        /* Get the next packetID to be resent. */
+        packetid_to_resend = MQTT_PublishToResend( &(mqtt_obj->mqtt_context), &cursor );
     }
 
-    return;
+    for( index = 0U; index < CY_MQTT_OUTGOING_PUBLISH_SLOTS; index++ )
+    {
+        if( expired[ index ] == true )
+        {
+            (void)mqtt_release_outgoing_publish( mqtt_obj, index );
+            mqtt_obj->stats.expired_count++;
+            mqtt_obj->outgoing_discard_count++;
+        }
+    }
+
+    return result;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-cy_rslt_t cy_mqtt_init( void )
+static void mqtt_awsport_network_disconnect_callback( void *user_data )
 {
-    cy_rslt_t result = CY_RSLT_SUCCESS;
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
 
-    if( (mqtt_lib_init_status == true) )
-    {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nMQTT library is already initialized. Number of MQTT client instance : [%d] \n", mqtt_handle_count );
-        return result;
-    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\n Network disconnection notification from socket layer.\n" );
 
-    result = cy_rtos_init_mutex2( &mqtt_db_mutex, false );
+    result = cy_rtos_put_queue( &mqtt_disconnect_event_queue, (void *)&user_data, CY_MQTT_DISCONNECT_EVENT_QUEUE_TIMEOUT_IN_MSEC, false );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCreating new mutex %p. failed", mqtt_db_mutex );
-        return result;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nPushing to disconnect event queue failed with Error : [0x%X] ", (unsigned int)result );
     }
-    mqtt_db_mutex_init_status = true;
 
-    result = cy_awsport_network_init();
-    if( result != CY_RSLT_SUCCESS )
+    return;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_codec_encode( cy_mqtt_object_t *mqtt_obj, cy_mqtt_publish_info_t *msg, char **encoded )
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    char      *out = NULL;
+    size_t    out_len = 0;
+
+    *encoded = NULL;
+    if( mqtt_obj->codec.encode == NULL )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_awsport_network_init failed with Error : [0x%X] ", (unsigned int)result );
-        (void)cy_rtos_deinit_mutex( &mqtt_db_mutex );
-        mqtt_db_mutex_init_status = false;
-        return result;
+        return CY_RSLT_SUCCESS;
     }
 
-    /*
-     * Initialize the queue for disconnect events.
-     */
-    result = cy_rtos_init_queue( &mqtt_disconnect_event_queue, CY_MQTT_DISCONNECT_EVENT_QUEUE_SIZE, sizeof(cy_mqtt_object_t *) );
+    result = mqtt_obj->codec.encode( mqtt_obj->codec.codec_ctx, msg->topic, msg->topic_len,
+                                     msg->payload, msg->payload_len, &out, &out_len );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_init_queue failed with Error : [0x%X] ", (unsigned int)result );
-        (void)cy_rtos_deinit_mutex( &mqtt_db_mutex );
-        (void)cy_awsport_network_deinit();
-        mqtt_db_mutex_init_status = false;
-        return result;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCodec failed to encode payload for topic %.*s with Error : [0x%X] ", msg->topic_len, msg->topic, (unsigned int)result );
+        return CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
     }
 
-    result = cy_rtos_create_thread( &mqtt_disconnect_event_thread, mqtt_disconn_event_thread, "MQTTdisconnectEventThread", NULL,
-                                    CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE, CY_MQTT_DISCONNECT_EVENT_THREAD_PRIORITY, NULL );
-    if( result != CY_RSLT_SUCCESS )
+    /* A NULL output means the codec left this payload as it is. */
+    if( out != NULL )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_create_thread failed with Error : [0x%X] ", (unsigned int)result );
-        (void)cy_rtos_deinit_mutex( &mqtt_db_mutex );
-        (void)cy_awsport_network_deinit();
-        (void)cy_rtos_deinit_queue( &mqtt_disconnect_event_queue );
-        mqtt_db_mutex_init_status = false;
-        return result;
+        msg->payload = out;
+        msg->payload_len = out_len;
+        *encoded = out;
     }
+    return CY_RSLT_SUCCESS;
+}
 
-    mqtt_lib_init_status = true;
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_awsport_network_init successful." );
+/*----------------------------------------------------------------------------------------------------------*/
 
-    return result;
+static void mqtt_codec_release( cy_mqtt_object_t *mqtt_obj, char *buffer )
+{
+    if( (buffer != NULL) && (mqtt_obj->codec.release != NULL) )
+    {
+        mqtt_obj->codec.release( mqtt_obj->codec.codec_ctx, buffer );
+    }
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-cy_rslt_t cy_mqtt_create( uint8_t *buffer, uint32_t bufflen,
-                          cy_awsport_ssl_credentials_t *security,
-                          cy_mqtt_broker_info_t *broker_info,
-                          cy_mqtt_callback_t event_callback,
-                          void *user_data,
-                          cy_mqtt_t *mqtt_handle )
+static void mqtt_event_callback( MQTTContext_t *param_mqtt_context,
+                                 MQTTPacketInfo_t *param_packet_info,
+                                 MQTTDeserializedInfo_t *param_deserialized_info )
 {
     cy_rslt_t         result = CY_RSLT_SUCCESS;
+    uint16_t          packet_id;
     cy_mqtt_object_t  *mqtt_obj = NULL;
-    uint8_t           slot_index;
-    bool              slot_found;
-    bool              process_mutex_init_status = false;
+    cy_mqtt_t         handle = NULL;
+    uint8_t           index = 0;
+    cy_mqtt_event_t   event;
+    char              *decoded = NULL;
+    size_t            decoded_len = 0;
 
-    if( (broker_info == NULL) || (mqtt_handle == NULL) || (event_callback == NULL) )
+    if( (param_mqtt_context == NULL) || (param_packet_info == NULL) || (param_deserialized_info == NULL) )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_create()..!\n" );
-        return CY_RSLT_MODULE_MQTT_BADARG;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n Bad arguments to mqtt_event_callback." );
+        return;
     }
 
-    if( buffer == NULL )
+    for( index = 0 ; index < CY_MQTT_MAX_HANDLE ; index++ )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid network buffer..!\n" );
-        return CY_RSLT_MODULE_MQTT_BADARG;
+        if( mqtt_handle_database[index].mqtt_context ==  param_mqtt_context )
+        {
+            handle = mqtt_handle_database[index].mqtt_handle;
+            break;
+        }
+    }
+
+    if( handle == NULL )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n Invalid MQTT Context.." );
+        return;
+    }
+
+    mqtt_obj = ( cy_mqtt_object_t * )handle;
+    packet_id = param_deserialized_info->packetIdentifier;
+
+    /* Handle incoming PUBLISH packets. The lower 4 bits of the PUBLISH packet
+     * type is used for the dup, QoS, and retain flags. Therefore, masking
+     * out the lower bits to check whether the packet is a PUBLISH packet. */
+    if( ( param_packet_info->type & 0xF0U ) == MQTT_PACKET_TYPE_PUBLISH )
+    {
+        if( param_deserialized_info->pPublishInfo != NULL )
+        {
+            /* Handle incoming PUBLISH packets. */
+            memset( &event, 0x00, sizeof(cy_mqtt_event_t) );
+            event.type = CY_MQTT_EVENT_TYPE_PUBLISH_RECEIVE;
+            event.data.pub_msg.packet_id = packet_id;
+            event.data.pub_msg.received_message.dup =  param_deserialized_info->pPublishInfo->dup;
+            event.data.pub_msg.received_message.payload = (const char *) (param_deserialized_info->pPublishInfo->pPayload);
+            event.data.pub_msg.received_message.payload_len = param_deserialized_info->pPublishInfo->payloadLength;
+            /* cy_mqtt_qos_t and MQTTQoS_t share the values 0 to 2. */
+            event.data.pub_msg.received_message.qos = (cy_mqtt_qos_t)param_deserialized_info->pPublishInfo->qos;
+            event.data.pub_msg.received_message.retain = param_deserialized_info->pPublishInfo->retain;
+            event.data.pub_msg.received_message.topic = param_deserialized_info->pPublishInfo->pTopicName;
+            event.data.pub_msg.received_message.topic_len = param_deserialized_info->pPublishInfo->topicNameLength;
+            mqtt_obj->stats.receive_count++;
+            mqtt_obj->stats.receive_bytes += param_deserialized_info->pPublishInfo->payloadLength;
+            if( mqtt_obj->codec.decode != NULL )
+            {
+                decoded = NULL;
+                decoded_len = 0;
+                result = mqtt_obj->codec.decode( mqtt_obj->codec.codec_ctx,
+                                                 event.data.pub_msg.received_message.topic, event.data.pub_msg.received_message.topic_len,
+                                                 event.data.pub_msg.received_message.payload, event.data.pub_msg.received_message.payload_len,
+                                                 &decoded, &decoded_len );
+                if( result != CY_RSLT_SUCCESS )
+                {
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCodec failed to decode payload for topic %.*s; message dropped. Error : [0x%X] ",
+                                     event.data.pub_msg.received_message.topic_len, event.data.pub_msg.received_message.topic, (unsigned int)result );
+                    return;
+                }
+                if( decoded != NULL )
+                {
+                    event.data.pub_msg.received_message.payload = decoded;
+                    event.data.pub_msg.received_message.payload_len = decoded_len;
+                }
+            }
+            /* Messages not matching any registered topic filter go to the default callback. */
+            if( (mqtt_filter_dispatch( mqtt_obj, &(mqtt_obj->filter_trie), event.data.pub_msg.received_message.topic,
+                                       event.data.pub_msg.received_message.topic_len, true, &event ) == 0) &&
+                (mqtt_obj->mqtt_event_cb != NULL) )
+            {
+                mqtt_obj->mqtt_event_cb( handle, event, mqtt_obj->user_data );
+            }
+            mqtt_codec_release( mqtt_obj, decoded );
+        }
+        else
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n Invalid pPublishInfo.." );
+            return;
+        }
+    }
+    else
+    {
+        /* Handle other packets. */
+        switch( param_packet_info->type )
+        {
+            case MQTT_PACKET_TYPE_SUBACK:
+
+                /* Make sure that the ACK packet identifier matches with the Request packet identifier. */
+                if( mqtt_obj->sent_packet_id != packet_id )
+                {
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nSUBACK packet identifier does not matches with Request packet identifier." );
+                }
+                else
+                {
+                    /* A SUBACK from the broker, containing the server response to our subscription request, has been received.
+                     * It contains the status code indicating server approval/rejection for the subscription to the single topic
+                     * requested. The SUBACK will be parsed to obtain the status code; this status code will be stored in the MQTT object
+                     * member 'sub_ack_status'. */
+                    result = mqtt_update_suback_status( mqtt_obj, param_packet_info );
+                    if( result != CY_RSLT_SUCCESS )
+                    {
+                        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n mqtt_update_suback_status failed..!\n" );
+                    }
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nSUBACK packet identifier matches with Request packet identifier." );
+                }
+                break;
+
+            case MQTT_PACKET_TYPE_UNSUBACK:
+                /* Make sure that the UNSUBACK packet identifier matches with the Request packet identifier. */
+                if( mqtt_obj->sent_packet_id != packet_id )
+                {
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nUNSUBACK packet identifier does not matches with Request packet identifier." );
+                    mqtt_obj->unsub_ack_received = false;
+                }
+                else
+                {
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nUNSUBACK packet identifier matches with Request packet identifier." );
+                    mqtt_obj->unsub_ack_received = true;
+                }
+                break;
+
+            case MQTT_PACKET_TYPE_PINGRESP:
+                if( param_deserialized_info->deserializationResult != MQTTSuccess )
+                {
+                    memset( &event, 0x00, sizeof(cy_mqtt_event_t) );
+                    event.type = CY_MQTT_EVENT_TYPE_DISCONNECT;
+                    event.data.reason = CY_MQTT_DISCONN_TYPE_BROKER_DOWN;
+                    if( mqtt_obj->mqtt_event_cb != NULL )
+                    {
+                        mqtt_obj->mqtt_event_cb( handle, event, mqtt_obj->user_data );
+                    }
+                    mqtt_obj->mqtt_session_established = false;
+                }
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPing response received." );
+                break;
+
+            case MQTT_PACKET_TYPE_PUBREC:
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPUBREC received for packet id %u.\n\n", packet_id );
+                if( param_deserialized_info->deserializationResult != MQTTSuccess )
+                {
+                    /* Not an ack of the publish; keep the slot so that the publisher retransmits on the ack timeout. */
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nPUBREC received with status %s.", MQTT_Status_strerror( param_deserialized_info->deserializationResult ) );
+                }
+                else
+                {
+                    /* Clean up the PUBLISH packet when a PUBREC is received. A freed slot tells the publisher that the ack has arrived. */
+                    (void)mqtt_cleanup_outgoing_publish_with_packet_id( mqtt_obj, packet_id );
+                }
+                break;
+
+            case MQTT_PACKET_TYPE_PUBREL:
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPUBREL received for packet id %u.\n", packet_id );
+                break;
+
+            case MQTT_PACKET_TYPE_PUBCOMP:
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPUBCOMP received for packet id %u.\n\n", packet_id );
+                break;
+
+            case MQTT_PACKET_TYPE_PUBACK:
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPUBACK received for packet id %u.\n\n", packet_id );
+                if( param_deserialized_info->deserializationResult != MQTTSuccess )
+                {
+                    /* Not an ack of the publish; keep the slot so that the publisher retransmits on the ack timeout. */
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nPUBACK received with status %s.", MQTT_Status_strerror( param_deserialized_info->deserializationResult ) );
+                }
+                else
+                {
+                    /* Clean up the PUBLISH packet when a PUBACK is received. A freed slot tells the publisher that the ack has arrived. */
+                    (void)mqtt_cleanup_outgoing_publish_with_packet_id( mqtt_obj, packet_id );
+                }
+                break;
+
+            case MQTT_PACKET_TYPE_DISCONNECT:
+                /* Because this is user-initiated disconnection, no need to notify the application.*/
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nDisconnect packet received:(%02x).\n\n", param_packet_info->type );
+                break;
+
+            /* Any other packet type is invalid. */
+            default:
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nUnknown packet type received:(%02x).\n\n", param_packet_info->type );
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_establish_session( cy_mqtt_object_t *mqtt_obj,
+                                         MQTTConnectInfo_t *connect_info,
+                                         MQTTPublishInfo_t *will_msg,
+                                         bool create_clean_session,
+                                         bool *session_present )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    MQTTStatus_t      mqttStatus = MQTTSuccess;
+
+    /* Establish an MQTT session by sending a CONNECT packet. */
+
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_establish_session - Acquired Mutex %p ", mqtt_obj->process_mutex );
+
+    if( connect_info->cleanSession == true )
+    {
+        /* No acknowledgment of the previous session can arrive on a clean session, so the state records of the
+         * publishes given up on are dropped by initializing the MQTT context afresh. */
+        result = mqtt_initialize_core_lib( &(mqtt_obj->mqtt_context), &(mqtt_obj->network_context),
+                                           mqtt_obj->network_buffer, mqtt_obj->network_buffer_len );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nmqtt_initialize_core_lib failed with Error : [0x%X] ", (unsigned int)result );
+            (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+            return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+        }
+    }
+
+    /* Send an MQTT CONNECT packet to the broker. */
+    mqttStatus = MQTT_Connect( &(mqtt_obj->mqtt_context), connect_info, will_msg, CY_MQTT_CONNACK_RECV_TIMEOUT_MS, session_present );
+    if( mqttStatus != MQTTSuccess )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nConnection with MQTT broker failed with status %s.", MQTT_Status_strerror( mqttStatus ) );
+
+        result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
+        }
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_establish_session - Released Mutex %p ", mqtt_obj->process_mutex );
+        return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+    }
+    else
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nMQTT connection successfully established with broker.\n\n" );
+        mqtt_obj->mqtt_session_established = true;
+        /* The round trip of a new connection, possibly to another endpoint, is measured afresh. */
+        mqtt_rtt_reset( mqtt_obj );
+    }
+
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
+        return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_establish_session - Released Mutex %p ", mqtt_obj->process_mutex );
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+static cy_mqtt_object_t *mqtt_get_object_from_network_context( NetworkContext_t *network_context )
+{
+    /* The network context is embedded in the MQTT object, so the object is found from the member offset. */
+    return (cy_mqtt_object_t *)( (uint8_t *)network_context - offsetof( cy_mqtt_object_t, network_context ) );
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static int32_t mqtt_transport_send( cy_mqtt_object_t *mqtt_obj, const void *buffer, size_t bytes_send )
+{
+    if( mqtt_obj->custom_transport == true )
+    {
+        return mqtt_obj->transport.send( mqtt_obj->transport.transport_ctx, buffer, bytes_send );
+    }
+
+    return cy_awsport_network_send( &(mqtt_obj->network_context), buffer, bytes_send );
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_cork_send( cy_mqtt_object_t *mqtt_obj, const uint8_t *buffer, size_t length )
+{
+    size_t     total_sent = 0;
+    int32_t    bytes_sent = 0;
+    uint32_t   start_time_ms = 0;
+
+    if( mqtt_obj->cork_failed == true )
+    {
+        return CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+    }
+
+    start_time_ms = Clock_GetTimeMs();
+    while( total_sent < length )
+    {
+        bytes_sent = mqtt_transport_send( mqtt_obj, &(buffer[ total_sent ]), (length - total_sent) );
+        if( bytes_sent < 0 )
+        {
+            break;
+        }
+
+        total_sent += (size_t)bytes_sent;
+        if( (total_sent < length) && ((Clock_GetTimeMs() - start_time_ms) >= mqtt_obj->config.message_send_timeout_ms) )
+        {
+            break;
+        }
+    }
+
+    if( total_sent < length )
+    {
+        /* A partly written packet leaves the stream out of step with the broker, so nothing more is written to it;
+         * the batch treats this as link loss. */
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nSending %u batched bytes failed after %u bytes..!\n", (unsigned int)length, (unsigned int)total_sent );
+        mqtt_obj->cork_failed = true;
+        return CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_cork_flush( cy_mqtt_object_t *mqtt_obj )
+{
+    cy_rslt_t  result = CY_RSLT_SUCCESS;
+
+    result = mqtt_cork_send( mqtt_obj, mqtt_obj->cork_buffer, mqtt_obj->cork_len );
+    if( result == CY_RSLT_SUCCESS )
+    {
+        /* Every message before the one being serialized is now with the transport. */
+        mqtt_obj->cork_unflushed_from = mqtt_obj->cork_msg_index;
+    }
+    mqtt_obj->cork_len = 0;
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static int32_t mqtt_network_send( NetworkContext_t *network_context, const void *buffer, size_t bytes_send )
+{
+    cy_mqtt_object_t *mqtt_obj = mqtt_get_object_from_network_context( network_context );
+
+    if( mqtt_obj->cork_buffer == NULL )
+    {
+        return mqtt_transport_send( mqtt_obj, buffer, bytes_send );
+    }
+
+    /* A batch publish is in progress. Collect the packets so that they leave in as few transport sends as possible. */
+    if( bytes_send > (CY_MQTT_BATCH_SEND_BUFFER_SIZE - mqtt_obj->cork_len) )
+    {
+        if( mqtt_cork_flush( mqtt_obj ) != CY_RSLT_SUCCESS )
+        {
+            return -1;
+        }
+    }
+
+    if( bytes_send >= CY_MQTT_BATCH_SEND_BUFFER_SIZE )
+    {
+        if( mqtt_cork_send( mqtt_obj, (const uint8_t *)buffer, bytes_send ) != CY_RSLT_SUCCESS )
+        {
+            return -1;
+        }
+        return (int32_t)bytes_send;
+    }
+
+    if( mqtt_obj->cork_failed == true )
+    {
+        return -1;
+    }
+
+    memcpy( &(mqtt_obj->cork_buffer[ mqtt_obj->cork_len ]), buffer, bytes_send );
+    mqtt_obj->cork_len += bytes_send;
+
+    return (int32_t)bytes_send;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+int32_t mqtt_awsport_network_receive( NetworkContext_t *network_context, void *buffer, size_t bytes_recv )
+{
+    int32_t          bytes_received = 0;
+    size_t           total_received = 0;
+    uint32_t         last_data_time_ms = 0;
+    cy_mqtt_object_t *mqtt_obj = mqtt_get_object_from_network_context( network_context );
+
+    /* The receive thread polls this function with no data pending most of the time.
+     * The clock is read only once data has arrived, so an empty poll costs a single socket read. */
+    do
+    {
+        if( mqtt_obj->custom_transport == true )
+        {
+            bytes_received = mqtt_obj->transport.recv( mqtt_obj->transport.transport_ctx, (void *)((char *)buffer + total_received), (bytes_recv - total_received) );
+        }
+        else
+        {
+            bytes_received = cy_awsport_network_receive( network_context, (void *)((char *)buffer + total_received), (bytes_recv - total_received) );
+        }
+        if( bytes_received < 0 )
+        {
+            return bytes_received;
+        }
+        else if( bytes_received == 0 )
+        {
+            if( total_received == 0 )
+            {
+                /* No data in the socket, so return. */
+                break;
+            }
+
+            /* Partial data is received. Wait for the rest until the receive timeout elapses. */
+            if( (Clock_GetTimeMs() - last_data_time_ms) >= mqtt_obj->config.message_receive_timeout_ms )
+            {
+                break;
+            }
+        }
+        else
+        {
+            total_received = total_received + (size_t)bytes_received;
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\n Total Bytes Received = %u", (unsigned int)total_received );
+            /* Reset the wait time as some data is received. */
+            last_data_time_ms = Clock_GetTimeMs();
+        }
+    } while( total_received < bytes_recv );
+
+    return (int32_t)total_received;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_select_endpoint( cy_mqtt_object_t *mqtt_obj, uint8_t index )
+{
+    memcpy( &(mqtt_obj->broker_info), &(mqtt_obj->endpoints[ index ]), sizeof(cy_mqtt_broker_info_t) );
+    mqtt_obj->server_info.host_name = mqtt_obj->endpoints[ index ].hostname;
+    mqtt_obj->server_info.port = mqtt_obj->endpoints[ index ].port;
+    mqtt_obj->connect_server_info = mqtt_obj->server_info;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_stats_add( cy_mqtt_object_t *mqtt_obj, uint32_t *counter, uint32_t value )
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    /* For the counters updated on paths that do not hold process_mutex. */
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return;
+    }
+
+    *counter += value;
+
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_update_dns_stats( cy_mqtt_object_t *mqtt_obj, bool cache_hit, uint32_t resolve_time_ms )
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return;
+    }
+
+    if( cache_hit == true )
+    {
+        mqtt_obj->stats.dns_cache_hit_count++;
+    }
+    else
+    {
+        mqtt_obj->stats.dns_resolve_count++;
+        mqtt_obj->stats.dns_resolve_time_total_ms += resolve_time_ms;
+    }
+
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_format_address( const cy_socket_ip_address_t *address, char *buffer, size_t size )
+{
+    uint32_t word = 0;
+    uint8_t  index = 0;
+    size_t   len = 0;
+
+    /* The address is stored in network byte order, so the first byte of the address is the lowest byte of each word. */
+    if( address->version == CY_SOCKET_IP_VER_V4 )
+    {
+        snprintf( buffer, size, "%u.%u.%u.%u",
+                  (unsigned int)( (address->ip.v4 >> 0) & 0xFF ), (unsigned int)( (address->ip.v4 >> 8) & 0xFF ),
+                  (unsigned int)( (address->ip.v4 >> 16) & 0xFF ), (unsigned int)( (address->ip.v4 >> 24) & 0xFF ) );
+        return;
+    }
+
+    buffer[ 0 ] = '\0';
+    for( index = 0; (index < 4) && (len < size); index++ )
+    {
+        word = address->ip.v6[ index ];
+        len += (size_t)snprintf( &buffer[ len ], size - len, "%s%x:%x", (index == 0) ? "" : ":",
+                                 (unsigned int)( ((word & 0xFF) << 8) | ((word >> 8) & 0xFF) ),
+                                 (unsigned int)( (((word >> 16) & 0xFF) << 8) | ((word >> 24) & 0xFF) ) );
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_resolve_endpoint( cy_mqtt_object_t *mqtt_obj, uint8_t index )
+{
+    cy_rslt_t               result = CY_RSLT_SUCCESS;
+    cy_mqtt_dns_cache_t     *entry = &(mqtt_obj->dns_cache[ index ]);
+    cy_socket_ip_address_t  address;
+    uint32_t                start_time_ms = 0;
+    uint32_t                resolve_time_ms = 0;
+
+    /* The resolved address is passed to the network layer in connect_server_info only; server_info keeps the host name,
+     * which TLS needs for the server name indication and the certificate check. */
+    if( (entry->valid == true) && ((Clock_GetTimeMs() - entry->resolved_time_ms) < CY_MQTT_DNS_CACHE_TTL_MS) )
+    {
+        mqtt_update_dns_stats( mqtt_obj, true, 0 );
+        mqtt_obj->connect_server_info.host_name = entry->address;
+        return;
+    }
+
+    /* Prefer an IPv4 address; fall back to IPv6 for IPv6-only brokers. */
+    memset( &address, 0x00, sizeof(address) );
+    start_time_ms = Clock_GetTimeMs();
+    result = cy_socket_gethostbyname( mqtt_obj->endpoints[ index ].hostname, CY_SOCKET_IP_VER_V4, &address );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        memset( &address, 0x00, sizeof(address) );
+        result = cy_socket_gethostbyname( mqtt_obj->endpoints[ index ].hostname, CY_SOCKET_IP_VER_V6, &address );
+    }
+    resolve_time_ms = Clock_GetTimeMs() - start_time_ms;
+    mqtt_update_dns_stats( mqtt_obj, false, resolve_time_ms );
+
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_socket_gethostbyname failed with Error : [0x%X] ", (unsigned int)result );
+        if( entry->valid == true )
+        {
+            /* Keep connecting to the last known address while DNS is unavailable. */
+            mqtt_obj->connect_server_info.host_name = entry->address;
+        }
+        return;
+    }
+
+    mqtt_format_address( &address, entry->address, sizeof(entry->address) );
+    entry->resolved_time_ms = Clock_GetTimeMs();
+    entry->valid = true;
+    mqtt_obj->connect_server_info.host_name = entry->address;
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nResolved %s to %s in %u ms.\n", mqtt_obj->endpoints[ index ].hostname, entry->address, (unsigned int)resolve_time_ms );
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static bool mqtt_host_is_ip_literal( const char *host_name )
+{
+    uint8_t parts = 0;
+    uint8_t digits = 0;
+
+    /* Any colon marks an IPv6 literal; host names and IPv4 literals cannot contain one. */
+    if( strchr( host_name, ':' ) != NULL )
+    {
+        return true;
+    }
+
+    /* An IPv4 literal is four dot-separated groups of one to three digits. */
+    for( ; ; host_name++ )
+    {
+        if( (*host_name >= '0') && (*host_name <= '9') )
+        {
+            if( ++digits > 3 )
+            {
+                return false;
+            }
+        }
+        else if( ((*host_name == '.') || (*host_name == '\0')) && (digits > 0) )
+        {
+            parts++;
+            digits = 0;
+            if( *host_name == '\0' )
+            {
+                return ( parts == 4 );
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_network_connect( cy_mqtt_object_t *mqtt_obj )
+{
+    cy_rslt_t                     result = CY_RSLT_SUCCESS;
+    cy_awsport_ssl_credentials_t  *security = NULL;
+
+    if( mqtt_obj->custom_transport == true )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nConnecting the application transport to %s:%d.", mqtt_obj->broker_info.hostname, mqtt_obj->broker_info.port );
+        result = mqtt_obj->transport.connect( mqtt_obj->transport.transport_ctx, &(mqtt_obj->broker_info),
+                                              mqtt_obj->config.message_send_timeout_ms, CY_MQTT_SOCKET_RECEIVE_TIMEOUT_MS );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nApplication transport connect failed with Error : [0x%X] ", (unsigned int)result );
+            return result;
+        }
+        mqtt_obj->network_connected = true;
+        return result;
+    }
+
+    if( mqtt_obj->mqtt_secure_mode == true )
+    {
+        /* The network layer may be given the resolved address instead of the host name; keep the host name for the server name indication.
+         * RFC 6066 does not allow an IP address as the server name, so no server name indication is sent for an address literal. */
+        mqtt_obj->connect_security = mqtt_obj->security;
+        if( (mqtt_obj->connect_security.sni_host_name == NULL) && (mqtt_host_is_ip_literal( mqtt_obj->server_info.host_name ) == false) )
+        {
+            mqtt_obj->connect_security.sni_host_name = mqtt_obj->server_info.host_name;
+            mqtt_obj->connect_security.sni_host_name_size = strlen( mqtt_obj->server_info.host_name ) + 1;
+        }
+        security = &(mqtt_obj->connect_security);
+    }
+
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nCreating MQTT socket..\n" );
+    result = cy_awsport_network_create( &(mqtt_obj->network_context), &(mqtt_obj->connect_server_info), security, &(mqtt_obj->network_context.disconnect_info) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_awsport_network_create failed with Error : [0x%X] ", (unsigned int)result );
+        return result;
+    }
+
+    /* Establish a TLS session with the MQTT broker. */
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "Establishing a TLS session to %.*s:%d.",
+                     strlen(mqtt_obj->server_info.host_name), mqtt_obj->server_info.host_name, mqtt_obj->server_info.port );
+    result = cy_awsport_network_connect( &(mqtt_obj->network_context),
+                                         mqtt_obj->config.message_send_timeout_ms,
+                                         CY_MQTT_SOCKET_RECEIVE_TIMEOUT_MS );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_awsport_network_connect failed with Error : [0x%X] ", (unsigned int)result );
+        (void)cy_awsport_network_delete( &(mqtt_obj->network_context) );
+        /*
+         * In case of an unexpected network disconnection, the cy_awsport_network_delete API always returns failure. Therefore,
+         * the return value of the cy_awsport_network_delete API is not checked here.
+         */
+        /* Fall-through. */
+    }
+    else
+    {
+        mqtt_obj->network_connected = true;
+    }
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_network_disconnect( cy_mqtt_object_t *mqtt_obj )
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if( mqtt_obj->network_connected == false )
+    {
+        /* Already closed; for example by the automatic reconnect after a failed attempt. */
+        return;
+    }
+    mqtt_obj->network_connected = false;
+
+    if( mqtt_obj->custom_transport == true )
+    {
+        result = mqtt_obj->transport.disconnect( mqtt_obj->transport.transport_ctx );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nApplication transport disconnect failed with Error : [0x%X] ", (unsigned int)result );
+        }
+        return;
+    }
+
+    result = cy_awsport_network_disconnect( &(mqtt_obj->network_context) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_awsport_network_disconnect failed with Error : [0x%X] ", (unsigned int)result );
+        /*
+         * In case of an unexpected network disconnection, the cy_awsport_network_disconnect API always returns failure. Therefore,
+         * the return value of the cy_awsport_network_disconnect API is not checked here.
+         */
+        /* Fall-through. */
+    }
+
+    result = cy_awsport_network_delete( &(mqtt_obj->network_context) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_awsport_network_delete failed with Error : [0x%X] ", (unsigned int)result );
+        /*
+         * In case of an unexpected network disconnection, the cy_awsport_network_delete API always returns failure. Therefore,
+         * the return value of the cy_awsport_network_delete API is not checked here.
+         */
+        /* Fall-through. */
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_initialize_core_lib( MQTTContext_t *param_mqtt_context,
+                                           NetworkContext_t *param_network_context,
+                                           uint8_t *networkbuff, uint32_t buff_len )
+{
+    cy_rslt_t            result = CY_RSLT_SUCCESS;
+    MQTTStatus_t         mqttStatus = MQTTSuccess;
+    MQTTFixedBuffer_t    networkBuffer;
+    TransportInterface_t transport;
+
+    if( (param_mqtt_context == NULL) || (param_network_context == NULL) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n Bad arguments to mqtt_initialize_core_lib." );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    memset( &networkBuffer, 0x00, sizeof(MQTTFixedBuffer_t) );
+    memset( &transport, 0x00, sizeof(TransportInterface_t) );
+
+    /* Fill in TransportInterface send and receive function pointers. */
+    transport.pNetworkContext = param_network_context;
+    transport.send = (TransportSend_t)&mqtt_network_send;
+    transport.recv = (TransportRecv_t)&mqtt_awsport_network_receive;
+
+    /* Fill the values for the network buffer. */
+    networkBuffer.pBuffer = networkbuff;
+    networkBuffer.size = buff_len;
+
+    /* Initialize the MQTT library. */
+    mqttStatus = MQTT_Init( param_mqtt_context, &transport, Clock_GetTimeMs,
+                            mqtt_event_callback, &networkBuffer );
+    if( mqttStatus != MQTTSuccess )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n MQTT init failed with Status = %s.", MQTT_Status_strerror( mqttStatus ) );
+        result = CY_RSLT_MODULE_MQTT_INIT_FAIL;
+    }
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_start_reconnect_thread( cy_mqtt_object_t *mqtt_obj )
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    /* The reconnect runs in a thread of its own, so that the disconnect event thread stays free to serve the other handles
+     * while this one backs off between attempts. The previous reconnect thread of the handle has finished its work, as
+     * reconnect_in_progress was false; join it to release its resources. */
+    if( mqtt_obj->reconnect_thread != NULL )
+    {
+        result = cy_rtos_join_thread( &mqtt_obj->reconnect_thread );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nJoin MQTT reconnect thread failed with Error : [0x%X] ", (unsigned int)result );
+        }
+        mqtt_obj->reconnect_thread = NULL;
+    }
+
+    result = cy_rtos_create_thread( &mqtt_obj->reconnect_thread, mqtt_auto_reconnect, "MQTTReconnect", NULL,
+                                    CY_MQTT_RECONNECT_THREAD_STACK_SIZE, CY_MQTT_RECONNECT_THREAD_PRIORITY, (cy_thread_arg_t)mqtt_obj );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT reconnect thread creation failed with Error : [0x%X] ", (unsigned int)result );
+        mqtt_obj->reconnect_thread = NULL;
+
+        result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+            return;
+        }
+        mqtt_obj->reconnect_in_progress = false;
+        (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_disconn_event_thread( cy_thread_arg_t arg )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_mqtt_t         handle = NULL;
+    cy_mqtt_object_t  *mqtt_obj = NULL;
+    cy_mqtt_event_t   event;
+    bool              start_reconnect = false;
+    (void)arg;
+
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nStarting mqtt_disconn_event_thread...\n" );
+
+    while( true )
+    {
+        result = cy_rtos_get_queue( &mqtt_disconnect_event_queue, (void *)&handle, CY_RTOS_NEVER_TIMEOUT, false );
+        if( CY_RSLT_SUCCESS != result )
+        {
+            continue;
+        }
+
+        memset( &event, 0x00, sizeof(cy_mqtt_event_t) );
+        event.type = CY_MQTT_EVENT_TYPE_DISCONNECT;
+
+        if( handle == NULL )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid mqtt handle...!\n" );
+        }
+        else
+        {
+            mqtt_obj = (cy_mqtt_object_t *)handle;
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_awsport_network_disconnect_callback - Acquiring Mutex %p ", mqtt_obj->process_mutex );
+            result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+            if( result != CY_RSLT_SUCCESS )
+            {
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+                continue;
+            }
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_awsport_network_disconnect_callback - Acquired Mutex %p ", mqtt_obj->process_mutex );
+
+            if( mqtt_obj->mqtt_session_established == true )
+            {
+                event.data.reason = CY_MQTT_DISCONN_TYPE_NETWORK_DOWN;
+                if( mqtt_obj->mqtt_event_cb != NULL )
+                {
+                    mqtt_obj->mqtt_event_cb( (cy_mqtt_t)mqtt_obj, event, mqtt_obj->user_data );
+                }
+                mqtt_obj->mqtt_session_established = false;
+            }
+
+            /* A link failure can be reported both by the socket layer and by the receive thread; only the first report
+             * starts a reconnect. The flag is set here so that the handle cannot be deleted before the reconnect thread runs. */
+            start_reconnect = false;
+            if( (mqtt_obj->auto_reconnect == true) && (mqtt_obj->mqtt_conn_status == true) &&
+                (mqtt_obj->reconnect_in_progress == false) )
+            {
+                mqtt_obj->reconnect_in_progress = true;
+                start_reconnect = true;
+            }
+
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_awsport_network_disconnect_callback - Releasing Mutex %p ", mqtt_obj->process_mutex );
+            result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+            if( result != CY_RSLT_SUCCESS )
+            {
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
+            }
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_awsport_network_disconnect_callback - Released Mutex %p ", mqtt_obj->process_mutex );
+
+            if( start_reconnect == true )
+            {
+                mqtt_start_reconnect_thread( mqtt_obj );
+            }
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_receive_thread( cy_thread_arg_t arg )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t  *mqtt_obj = NULL;
+    MQTTStatus_t      mqtt_status = MQTTSuccess;
+    cy_mqtt_event_t   event;
+    bool              connect_status = true;
+    bool              link_lost = false;
+    int32_t           wait_status = 0;
+
+    mqtt_obj = (cy_mqtt_object_t *)arg;
+
+    if( (mqtt_obj == NULL) || (mqtt_obj->mqtt_obj_initialized == false) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        cy_rtos_exit_thread();
+        return;
+    }
+
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nStarting MQTT Receive thread for MQTT handle : %p \n", (cy_mqtt_t)mqtt_obj );
+
+    /* The thread exits when recv_thread_stop is set, only between passes, so that it never dies holding a mutex. */
+    while( mqtt_obj->recv_thread_stop == false )
+    {
+        result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+            break;
+        }
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_receive_thread - Acquired Mutex %p ", mqtt_obj->process_mutex );
+
+        connect_status = mqtt_obj->mqtt_session_established;
+        if( connect_status )
+        {
+            mqtt_status = MQTT_ProcessLoop( &(mqtt_obj->mqtt_context), CY_MQTT_RECEIVE_DATA_TIMEOUT_MS );
+            if( mqtt_status != MQTTSuccess )
+            {
+                if( (mqtt_status == MQTTRecvFailed)  || (mqtt_status == MQTTSendFailed) ||
+                    (mqtt_status == MQTTBadResponse) || (mqtt_status == MQTTKeepAliveTimeout) ||
+                    (mqtt_status == MQTTIllegalState ) )
+                {
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nmqtt_receive_thread MQTT_ProcessLoop failed with status %s \n", MQTT_Status_strerror(mqtt_status) );
+                    memset( &event, 0x00, sizeof(cy_mqtt_event_t) );
+
+                    if( mqtt_status == MQTTKeepAliveTimeout )
+                    {
+                        event.type = CY_MQTT_EVENT_TYPE_DISCONNECT;
+                        event.data.reason = CY_MQTT_DISCONN_TYPE_BROKER_DOWN;
+                        if( mqtt_obj->mqtt_event_cb != NULL )
+                        {
+                            mqtt_obj->mqtt_event_cb( (cy_mqtt_t)mqtt_obj, event, mqtt_obj->user_data );
+                        }
+                        mqtt_obj->mqtt_session_established = false;
+                        link_lost = true;
+                    }
+                    else if( (mqtt_obj->custom_transport == true) &&
+                             ((mqtt_status == MQTTRecvFailed) || (mqtt_status == MQTTSendFailed)) )
+                    {
+                        /* The application transport has no socket-layer disconnect notification, so a broken link is reported here. */
+                        event.type = CY_MQTT_EVENT_TYPE_DISCONNECT;
+                        event.data.reason = CY_MQTT_DISCONN_TYPE_NETWORK_DOWN;
+                        if( mqtt_obj->mqtt_event_cb != NULL )
+                        {
+                            mqtt_obj->mqtt_event_cb( (cy_mqtt_t)mqtt_obj, event, mqtt_obj->user_data );
+                        }
+                        mqtt_obj->mqtt_session_established = false;
+                        link_lost = true;
+                    }
+                }
+            }
+        }
+
+        result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
+        }
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_receive_thread - Released Mutex %p ", mqtt_obj->process_mutex );
+
+        if( (link_lost == true) && (mqtt_obj->auto_reconnect == true) )
+        {
+            /* No socket-layer notification follows a keepalive timeout or a broken application transport,
+             * so hand the handle to the disconnect event thread for the automatic reconnect. */
+            result = cy_rtos_put_queue( &mqtt_disconnect_event_queue, (void *)&mqtt_obj, CY_MQTT_DISCONNECT_EVENT_QUEUE_TIMEOUT_IN_MSEC, false );
+            if( result != CY_RSLT_SUCCESS )
+            {
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nPushing to disconnect event queue failed with Error : [0x%X] ", (unsigned int)result );
+            }
+        }
+
+        if( (link_lost == false) && (mqtt_obj->mqtt_session_established == true) && (mqtt_obj->recv_thread_stop == false) )
+        {
+            mqtt_rate_poll( mqtt_obj );
+            mqtt_drain_coalesce_table( mqtt_obj );
+        }
+        link_lost = false;
+
+        if( mqtt_obj->recv_thread_stop == true )
+        {
+            break;
+        }
+
+        if( (connect_status == true) && (mqtt_obj->custom_transport == true) && (mqtt_obj->transport.wait != NULL) )
+        {
+            /* Block on the transport until data arrives, so that incoming packets are not delayed by the polling interval.
+             * The wait is bounded by the polling interval so that keepalive processing still runs on an idle link. */
+            wait_status = mqtt_obj->transport.wait( mqtt_obj->transport.transport_ctx, mqtt_obj->config.receive_thread_sleep_ms );
+            if( wait_status < 0 )
+            {
+                cy_rtos_delay_milliseconds( mqtt_obj->config.receive_thread_sleep_ms );
+            }
+        }
+        else
+        {
+            cy_rtos_delay_milliseconds( mqtt_obj->config.receive_thread_sleep_ms );
+        }
+    }
+
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nMQTT Receive thread for MQTT handle %p exiting.\n", (cy_mqtt_t)mqtt_obj );
+    cy_rtos_exit_thread();
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_init( void )
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if( (mqtt_lib_init_status == true) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nMQTT library is already initialized. Number of MQTT client instance : [%d] \n", mqtt_handle_count );
+        return result;
+    }
+
+    result = cy_rtos_init_mutex2( &mqtt_db_mutex, false );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCreating new mutex %p. failed", mqtt_db_mutex );
+        return result;
+    }
+    mqtt_db_mutex_init_status = true;
+
+    result = cy_awsport_network_init();
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_awsport_network_init failed with Error : [0x%X] ", (unsigned int)result );
+        (void)cy_rtos_deinit_mutex( &mqtt_db_mutex );
+        mqtt_db_mutex_init_status = false;
+        return result;
+    }
+
+    /*
+     * Initialize the queue for disconnect events.
+     */
+    result = cy_rtos_init_queue( &mqtt_disconnect_event_queue, CY_MQTT_DISCONNECT_EVENT_QUEUE_SIZE, sizeof(cy_mqtt_object_t *) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_init_queue failed with Error : [0x%X] ", (unsigned int)result );
+        (void)cy_rtos_deinit_mutex( &mqtt_db_mutex );
+        (void)cy_awsport_network_deinit();
+        mqtt_db_mutex_init_status = false;
+        return result;
+    }
+
+    result = cy_rtos_create_thread( &mqtt_disconnect_event_thread, mqtt_disconn_event_thread, "MQTTdisconnectEventThread", NULL,
+                                    CY_MQTT_DISCONNECT_EVENT_THREAD_STACK_SIZE, CY_MQTT_DISCONNECT_EVENT_THREAD_PRIORITY, NULL );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_create_thread failed with Error : [0x%X] ", (unsigned int)result );
+        (void)cy_rtos_deinit_mutex( &mqtt_db_mutex );
+        (void)cy_awsport_network_deinit();
+        (void)cy_rtos_deinit_queue( &mqtt_disconnect_event_queue );
+        mqtt_db_mutex_init_status = false;
+        return result;
+    }
+
+    mqtt_lib_init_status = true;
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_awsport_network_init successful." );
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_create_object( uint8_t *buffer, uint32_t bufflen,
+                                     cy_awsport_ssl_credentials_t *security,
+                                     cy_mqtt_transport_t *transport,
+                                     cy_mqtt_broker_info_t *broker_info,
+                                     cy_mqtt_callback_t event_callback,
+                                     void *user_data,
+                                     cy_mqtt_t *mqtt_handle )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t  *mqtt_obj = NULL;
+    uint8_t           slot_index;
+    bool              slot_found;
+    bool              process_mutex_init_status = false;
+    bool              flow_mutex_init_status = false;
+    bool              coalesce_mutex_init_status = false;
+    bool              priority_event_init_status = false;
+
+    if( (broker_info == NULL) || (mqtt_handle == NULL) || (event_callback == NULL) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_create()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    if( buffer == NULL )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid network buffer..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    if( bufflen < CY_MQTT_MIN_NETWORK_BUFFER_SIZE )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBuffer length is less then minimun network buffer size : %u..!\n", (uint16_t)CY_MQTT_MIN_NETWORK_BUFFER_SIZE );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    if( (mqtt_lib_init_status == false) || (mqtt_db_mutex_init_status == false) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nLibrary init is not done/Global mutex is not initialized..!\n " );
+        return CY_RSLT_MODULE_MQTT_CREATE_FAIL;
+    }
+
+    result = cy_rtos_get_mutex( &mqtt_db_mutex, CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
+        return result;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_create - Acquired Mutex %p ", mqtt_db_mutex );
+
+    if( mqtt_handle_count >= CY_MQTT_MAX_HANDLE )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nNumber of created mqtt object exceeds %d..!\n", CY_MQTT_MAX_HANDLE );
+        (void)cy_rtos_set_mutex( &mqtt_db_mutex );
+        return CY_RSLT_MODULE_MQTT_CREATE_FAIL;
+    }
+
+    result = cy_rtos_set_mutex( &mqtt_db_mutex );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
+        return result;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_create - Released Mutex %p ", mqtt_db_mutex );
+
+    mqtt_obj = (cy_mqtt_object_t *)malloc( sizeof( cy_mqtt_object_t ) );
+    if( mqtt_obj == NULL )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to create MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_NOMEM;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_obj : %p..!\n", mqtt_obj );
+
+    /* Clear the MQTT handle data. */
+    memset( mqtt_obj, 0x00, sizeof( cy_mqtt_object_t ) );
+
+    mqtt_obj->mqtt_obj_initialized = false;
+    if( security != NULL )
+    {
+        mqtt_obj->security.alpnprotos = security->alpnprotos;
+        mqtt_obj->security.alpnprotoslen = security->alpnprotoslen;
+        mqtt_obj->security.sni_host_name = security->sni_host_name;
+        mqtt_obj->security.sni_host_name_size = security->sni_host_name_size;
+        mqtt_obj->security.username = security->username;
+        mqtt_obj->security.username_size = security->username_size;
+        mqtt_obj->security.password = security->password;
+        mqtt_obj->security.password_size = security->password_size;
+
+        mqtt_obj->security.client_cert = security->client_cert;
+        mqtt_obj->security.client_cert_size = security->client_cert_size;
+        mqtt_obj->security.private_key = security->private_key;
+        mqtt_obj->security.private_key_size = security->private_key_size;
+        mqtt_obj->security.root_ca = security->root_ca;
+        mqtt_obj->security.root_ca_size = security->root_ca_size;
+        mqtt_obj->mqtt_secure_mode = true;
+    }
+    else
+    {
+        mqtt_obj->mqtt_secure_mode = false;
+    }
+
+    if( transport != NULL )
+    {
+        memcpy( &(mqtt_obj->transport), transport, sizeof(cy_mqtt_transport_t) );
+        mqtt_obj->custom_transport = true;
+    }
+
+    memcpy( &(mqtt_obj->endpoints[ 0 ]), broker_info, sizeof(cy_mqtt_broker_info_t) );
+    mqtt_obj->num_endpoints = 1;
+    mqtt_obj->last_good_endpoint = 0;
+    mqtt_select_endpoint( mqtt_obj, 0 );
+    mqtt_obj->mqtt_event_cb = event_callback;
+    mqtt_obj->user_data = user_data;
+
+    mqtt_obj->config.ack_receive_timeout_ms = CY_MQTT_ACK_RECEIVE_TIMEOUT_MS;
+    mqtt_obj->config.ack_timeout_min_ms = CY_MQTT_ACK_TIMEOUT_MIN_MS;
+    mqtt_obj->config.ack_timeout_max_ms = CY_MQTT_ACK_TIMEOUT_MAX_MS;
+    mqtt_obj->config.message_send_timeout_ms = CY_MQTT_MESSAGE_SEND_TIMEOUT_MS;
+    mqtt_obj->config.message_receive_timeout_ms = CY_MQTT_MESSAGE_RECEIVE_TIMEOUT_MS;
+    mqtt_obj->config.max_retry_value = CY_MQTT_MAX_RETRY_VALUE;
+    mqtt_obj->config.receive_thread_sleep_ms = CY_MQTT_RECEIVE_THREAD_SLEEP_MS;
+    mqtt_obj->config.receive_thread_priority = CY_MQTT_RECEIVE_THREAD_PRIORITY;
+    mqtt_obj->config.receive_thread_stack_size = CY_MQTT_RECEIVE_THREAD_STACK_SIZE;
+    mqtt_obj->config.rate_limit_msgs_per_sec = CY_MQTT_RATE_LIMIT_MSGS_PER_SEC;
+    mqtt_obj->config.rate_limit_bytes_per_sec = CY_MQTT_RATE_LIMIT_BYTES_PER_SEC;
+    mqtt_rate_reset( mqtt_obj );
+    mqtt_rtt_reset( mqtt_obj );
+
+    if( user_data == NULL )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nArgument user_data is NULL..!\n" );
+    }
+
+    result = cy_rtos_init_mutex2( &(mqtt_obj->process_mutex), false );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCreating new mutex %p. failed", mqtt_obj->process_mutex );
+        goto exit;
+    }
+
+    process_mutex_init_status = true;
+
+    result = cy_rtos_init_mutex2( &(mqtt_obj->flow_mutex), false );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCreating new mutex %p. failed", mqtt_obj->flow_mutex );
+        goto exit;
+    }
+
+    flow_mutex_init_status = true;
+
+    result = cy_rtos_init_mutex2( &(mqtt_obj->coalesce_mutex), false );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCreating new mutex %p. failed", mqtt_obj->coalesce_mutex );
+        goto exit;
+    }
+
+    coalesce_mutex_init_status = true;
+
+    result = cy_rtos_init_event( &(mqtt_obj->priority_event) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCreating priority event failed with Error : [0x%X] ", (unsigned int)result );
+        goto exit;
+    }
+
+    priority_event_init_status = true;
+    (void)cy_rtos_setbits_event( &(mqtt_obj->priority_event), (CY_MQTT_PRIORITY_EVENT_NO_HIGH_PRIORITY | CY_MQTT_PRIORITY_EVENT_NO_YIELD), false );
+
+    mqtt_obj->network_buffer = buffer;
+    mqtt_obj->network_buffer_len = bufflen;
+    result = mqtt_initialize_core_lib( &(mqtt_obj->mqtt_context), &(mqtt_obj->network_context), buffer, bufflen );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nmqtt_initialize_core_lib failed with Error : [0x%X] ", (unsigned int)result );
+        goto exit;
+    }
+    else
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_initialize_core_lib successful." );
+    }
+
+    mqtt_obj->network_context.disconnect_info.cbf = mqtt_awsport_network_disconnect_callback;
+    mqtt_obj->network_context.disconnect_info.user_data = ( void * )mqtt_obj;
+
+    result = cy_rtos_get_mutex( &mqtt_db_mutex, CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
+        goto exit;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_create - Acquired Mutex %p ", mqtt_db_mutex );
+
+    slot_index = 0;
+    slot_found = false;
+
+    while( slot_index < CY_MQTT_MAX_HANDLE )
+    {
+        if( mqtt_handle_database[slot_index].mqtt_handle == NULL )
+        {
+            mqtt_handle_database[slot_index].mqtt_handle = (void *)mqtt_obj;
+            mqtt_handle_database[slot_index].mqtt_context = &(mqtt_obj->mqtt_context);
+            slot_found = true;
+            break;
+        }
+        slot_index++;
+    }
+
+    if( slot_found == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n Free slot not available for new handle..!\n" );
+        (void)cy_rtos_set_mutex( &mqtt_db_mutex );
+        result = CY_RSLT_MODULE_MQTT_CREATE_FAIL;
+        goto exit;
+    }
+
+    mqtt_obj->mqtt_obj_initialized = true;
+    mqtt_obj->mqtt_obj_index = slot_index;
+    *mqtt_handle = (void *)mqtt_obj;
+    mqtt_handle_count++;
+
+    result = cy_rtos_set_mutex( &mqtt_db_mutex );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
+        goto exit;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_create - Released Mutex %p ", mqtt_db_mutex );
+
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nMQTT object created successfully..\n" );
+    return CY_RSLT_SUCCESS;
+
+exit :
+    if( mqtt_obj != NULL )
+    {
+        if( process_mutex_init_status == true )
+        {
+            (void)cy_rtos_deinit_mutex( &(mqtt_obj->process_mutex) );
+            process_mutex_init_status = false;
+        }
+        if( flow_mutex_init_status == true )
+        {
+            (void)cy_rtos_deinit_mutex( &(mqtt_obj->flow_mutex) );
+            flow_mutex_init_status = false;
+        }
+        if( coalesce_mutex_init_status == true )
+        {
+            (void)cy_rtos_deinit_mutex( &(mqtt_obj->coalesce_mutex) );
+            coalesce_mutex_init_status = false;
+        }
+        if( priority_event_init_status == true )
+        {
+            (void)cy_rtos_deinit_event( &(mqtt_obj->priority_event) );
+            priority_event_init_status = false;
+        }
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\n Free mqtt_obj : %p..!\n", mqtt_obj );
+        free( mqtt_obj );
+    }
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_create( uint8_t *buffer, uint32_t bufflen,
+                          cy_awsport_ssl_credentials_t *security,
+                          cy_mqtt_broker_info_t *broker_info,
+                          cy_mqtt_callback_t event_callback,
+                          void *user_data,
+                          cy_mqtt_t *mqtt_handle )
+{
+    return mqtt_create_object( buffer, bufflen, security, NULL, broker_info, event_callback, user_data, mqtt_handle );
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_create_with_transport( uint8_t *buffer, uint32_t bufflen,
+                                         cy_mqtt_transport_t *transport,
+                                         cy_mqtt_broker_info_t *broker_info,
+                                         cy_mqtt_callback_t event_callback,
+                                         void *user_data,
+                                         cy_mqtt_t *mqtt_handle )
+{
+    if( (transport == NULL) || (transport->connect == NULL) || (transport->disconnect == NULL) ||
+        (transport->send == NULL) || (transport->recv == NULL) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_create_with_transport()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    return mqtt_create_object( buffer, bufflen, NULL, transport, broker_info, event_callback, user_data, mqtt_handle );
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_stop_receive_thread( cy_mqtt_object_t *mqtt_obj )
+{
+    cy_rslt_t res = CY_RSLT_SUCCESS;
+
+    /* The caller must not hold process_mutex, which the receive thread takes on every pass. The thread is asked
+     * to exit and joined instead of being terminated, so that it cannot die holding process_mutex, flow_mutex or
+     * coalesce_mutex, or in the middle of a coalesced publish. */
+    if( mqtt_obj->recv_thread == NULL )
+    {
+        return;
+    }
+
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nStopping MQTT receive thread %p..!\n", mqtt_obj->recv_thread );
+    mqtt_obj->recv_thread_stop = true;
+
+    res = cy_rtos_join_thread( &mqtt_obj->recv_thread );
+    if( res != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nJoin MQTT receive thread failed with Error : [0x%X] ", (unsigned int)res );
+        /*
+         * In case of an unexpected thread failure, the cy_rtos_join_thread API always returns failure. Therefore,
+         * the return value of the cy_rtos_join_thread API is not checked here.
+         */
+        /* Fall-through. */
+    }
+    mqtt_obj->recv_thread = NULL;
+    mqtt_obj->recv_thread_stop = false;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_teardown_session( cy_mqtt_object_t *mqtt_obj )
+{
+    cy_rslt_t         res = CY_RSLT_SUCCESS;
+    MQTTStatus_t      mqttStatus = MQTTSuccess;
+
+    /* The caller must not hold process_mutex. */
+    mqtt_stop_receive_thread( mqtt_obj );
+
+    res = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( res != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)res );
+        return;
+    }
+
+    if( mqtt_obj->mqtt_session_established == true )
+    {
+        mqttStatus = MQTT_Disconnect( &(mqtt_obj->mqtt_context) );
+        if( mqttStatus != MQTTSuccess )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "Sending MQTT DISCONNECT failed with status=%s.",
+                             MQTT_Status_strerror( mqttStatus ) );
+            /*
+             * In case of an unexpected network disconnection, the MQTT_Disconnect API always returns failure. Therefore,
+             * the return value of the MQTT_Disconnect API is not checked here.
+             */
+            /* Fall-through. */
+        }
+        mqtt_obj->mqtt_session_established = false;
+    }
+
+    mqtt_network_disconnect( mqtt_obj );
+
+    res = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( res != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)res );
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_connect_session( cy_mqtt_object_t *mqtt_obj, cy_mqtt_connect_info_t *connect_info, bool retry_with_backoff )
+{
+    cy_rslt_t                     result = CY_RSLT_SUCCESS;
+    RetryUtilsParams_t            reconnectParams;
+    RetryUtilsStatus_t            retryUtilsStatus = RetryUtilsSuccess;
+    bool                          create_clean_session = false;
+    MQTTConnectInfo_t             connect_details;
+    MQTTPublishInfo_t             will_msg_details;
+    MQTTPublishInfo_t             *will_msg_ptr = NULL;
+    uint8_t                       attempt = 0;
+    uint8_t                       endpoint = 0;
+
+    memset( &connect_details, 0x00, sizeof( MQTTConnectInfo_t ) );
+    memset( &will_msg_details, 0x00, sizeof( MQTTPublishInfo_t ) );
+
+    /* Connect Information */
+    connect_details.cleanSession = connect_info->clean_session;
+    connect_details.keepAliveSeconds = connect_info->keep_alive_sec;
+    connect_details.pClientIdentifier = connect_info->client_id;
+    connect_details.clientIdentifierLength = connect_info->client_id_len;
+    connect_details.pPassword = connect_info->password;
+    connect_details.passwordLength = connect_info->password_len;
+    connect_details.pUserName = connect_info->username;
+    connect_details.userNameLength = connect_info->username_len;
+
+    if( connect_info->will_info != NULL )
+    {
+        /* Will information. */
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nWill info is not NULL ..!\n" );
+
+        if( connect_info->will_info->qos > CY_MQTT_QOS2 )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid Will msg QoS..!\n" );
+            return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+        }
+        if( (connect_info->will_info->dup != true) && (connect_info->will_info->dup != false) )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid Will msg dup..!\n" );
+            return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+        }
+        if( (connect_info->will_info->retain != true) && (connect_info->will_info->retain != false) )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid Will msg retain..!\n" );
+            return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+        }
+
+        if( connect_info->will_info->qos == CY_MQTT_QOS0 )
+        {
+            will_msg_details.qos = MQTTQoS0;
+        }
+        else if( connect_info->will_info->qos == CY_MQTT_QOS1 )
+        {
+            will_msg_details.qos = MQTTQoS1;
+        }
+        else
+        {
+            will_msg_details.qos = MQTTQoS2;
+        }
+
+        will_msg_details.dup = connect_info->will_info->dup;
+        will_msg_details.retain = connect_info->will_info->retain;
+        will_msg_details.pTopicName = connect_info->will_info->topic;
+        will_msg_details.topicNameLength = connect_info->will_info->topic_len;
+        will_msg_details.pPayload = connect_info->will_info->payload;
+        will_msg_details.payloadLength = connect_info->will_info->payload_len;
+        will_msg_ptr = &will_msg_details;
+    }
+    else
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nWill info is NULL ..!\n" );
+        will_msg_ptr = NULL;
+    }
+
+    /* Initialize the reconnect attempts and interval. */
+    RetryUtils_ParamsReset( &reconnectParams );
+
+    /* Attempt to connect to an MQTT broker. If connection fails, retry after
+     * a timeout. The timeout value will exponentially increase until the maximum
+     * attempts are reached. Without retry_with_backoff, the endpoints are tried
+     * once each and the caller spaces the attempts.
+     */
+    do
+    {
+        /* Try every endpoint once per attempt, starting with the one that connected last,
+         * so that a single unreachable endpoint costs one connect timeout rather than the whole backoff sequence. */
+        for( attempt = 0; attempt < mqtt_obj->num_endpoints; attempt++ )
+        {
+            endpoint = (uint8_t)( (mqtt_obj->last_good_endpoint + attempt) % mqtt_obj->num_endpoints );
+            mqtt_select_endpoint( mqtt_obj, endpoint );
+            if( mqtt_obj->custom_transport == false )
+            {
+                mqtt_resolve_endpoint( mqtt_obj, endpoint );
+            }
+
+            result = mqtt_network_connect( mqtt_obj );
+            if( result == CY_RSLT_SUCCESS )
+            {
+                mqtt_obj->last_good_endpoint = endpoint;
+                break;
+            }
+
+            /* The broker may have moved; resolve the host name again on the next attempt. */
+            mqtt_obj->dns_cache[ endpoint ].resolved_time_ms = Clock_GetTimeMs() - CY_MQTT_DNS_CACHE_TTL_MS;
+        }
+
+        if( (result != CY_RSLT_SUCCESS) && (retry_with_backoff == false) )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nConnection to the broker failed on every endpoint.\n" );
+            result = CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+            break;
+        }
+
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nConnection to the broker failed. Retrying connection with backoff and jitter.\n" );
+            mqtt_stats_add( mqtt_obj, &(mqtt_obj->stats.connect_retry_count), 1 );
+            retryUtilsStatus = RetryUtils_BackoffAndSleep( &reconnectParams );
+            if( retryUtilsStatus == RetryUtilsRetriesExhausted )
+            {
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nConnection to the broker failed, all attempts exhausted.\n" );
+                result = CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+            }
+        }
+    } while( ( result != CY_RSLT_SUCCESS ) && ( retryUtilsStatus == RetryUtilsSuccess ) );
+
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nTLS connection failed with Error : [0x%X] ", (unsigned int)result );
+        return result;
+    }
+
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nTLS connection established ..\n" );
+
+    create_clean_session = (connect_details.cleanSession == true ) ? false : true;
+    if( create_clean_session == true )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nCreating clean session ..\n" );
+    }
+
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nCreating an MQTT connection to %.*s.",
+                     strlen(mqtt_obj->server_info.host_name), mqtt_obj->server_info.host_name );
+
+    /* Sends an MQTT Connect packet using the established TLS session. */
+    result = mqtt_establish_session( mqtt_obj, &connect_details, will_msg_ptr, create_clean_session, &(mqtt_obj->broker_session_present) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nEstablish MQTT session failed with Error : [0x%X] ", (unsigned int)result );
+        goto exit;
+    }
+    else
+    {
+        if( mqtt_obj->recv_thread == NULL )
+        {
+            char th_name[32];
+            static uint8_t thread_sno = 0;
+
+            snprintf( th_name, sizeof(th_name), "%d%s", ++thread_sno, " -MQTTReceive\n"  );
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nCreating MQTT Receive thread......\n" );
+            mqtt_obj->recv_thread = NULL;
+            result = cy_rtos_create_thread( &mqtt_obj->recv_thread,
+                                            mqtt_receive_thread,
+                                            th_name,
+                                            NULL,
+                                            mqtt_obj->config.receive_thread_stack_size,
+                                            mqtt_obj->config.receive_thread_priority,
+                                            (cy_thread_arg_t)mqtt_obj );
+            if( result != CY_RSLT_SUCCESS )
+            {
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT receive thread creation failed with Error : [0x%X] ", (unsigned int)result );
+                goto exit;
+            }
+        }
+
+        /* The receive thread is running, and a publisher may be yielding to a high-priority publish;
+         * the outgoing slots are updated under process_mutex. */
+        result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+            goto exit;
+        }
+
+        if( (mqtt_obj->broker_session_present == true) && (create_clean_session == false) )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nMQTT session with broker is re-established. Resending unacked publishes." );
+            /* Handle all resend of PUBLISH messages. */
+            result = mqtt_handle_publish_resend( mqtt_obj );
+            if( result != CY_RSLT_SUCCESS )
+            {
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nHandle all the resend of PUBLISH messages failed with Error : [0x%X] ", (unsigned int)result );
+            }
+        }
+        else
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\n A clean MQTT connection is established. Cleaning up all the stored outgoing publishes." );
+
+            /* Clean up the outgoing PUBLISH packets and wait for ack because this new
+             * connection does not re-establish an existing session. */
+            result = mqtt_cleanup_outgoing_publishes( mqtt_obj );
+            if( result != CY_RSLT_SUCCESS )
+            {
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCleaning of PUBLISH messages failed with Error : [0x%X] ", (unsigned int)result );
+            }
+        }
+
+        (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            goto exit;
+        }
+    }
+
+    return result;
+
+exit :
+    mqtt_teardown_session( mqtt_obj );
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_set_broker_endpoints( cy_mqtt_t mqtt_handle, cy_mqtt_broker_info_t *endpoints, uint8_t count )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t  *mqtt_obj;
+    uint8_t           index = 0;
+
+    if( (mqtt_handle == NULL) || (endpoints == NULL) || (count < 1) || (count > CY_MQTT_MAX_BROKER_ENDPOINTS) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_set_broker_endpoints()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    for( index = 0; index < count; index++ )
+    {
+        if( endpoints[ index ].hostname == NULL )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid host name for broker endpoint %d..!\n", index );
+            return CY_RSLT_MODULE_MQTT_BADARG;
+        }
+    }
+
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+    }
+
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return result;
+    }
+
+    if( mqtt_obj->mqtt_conn_status == true )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client already connected..!\n" );
+        (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+        return CY_RSLT_MODULE_MQTT_ALREADY_CONNECTED;
+    }
+
+    memcpy( mqtt_obj->endpoints, endpoints, (sizeof(cy_mqtt_broker_info_t) * count) );
+    memset( mqtt_obj->dns_cache, 0x00, sizeof(mqtt_obj->dns_cache) );
+    mqtt_obj->num_endpoints = count;
+    mqtt_obj->last_good_endpoint = 0;
+    mqtt_select_endpoint( mqtt_obj, 0 );
+
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return result;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_connect( cy_mqtt_t mqtt_handle, cy_mqtt_connect_info_t *connect_info )
+{
+    cy_rslt_t                     result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t              *mqtt_obj;
+
+    if( (mqtt_handle == NULL) || (connect_info == NULL) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_connect()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+    }
+
+    if( mqtt_obj->mqtt_conn_status == true )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client already connected..!\n" );
+        return CY_RSLT_MODULE_MQTT_ALREADY_CONNECTED;
+    }
+
+    result = mqtt_connect_session( mqtt_obj, connect_info, true );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        return result;
+    }
+
+    /* Keep the connect parameters for the automatic reconnect. */
+    memcpy( &(mqtt_obj->connect_info), connect_info, sizeof(cy_mqtt_connect_info_t) );
+    if( connect_info->will_info != NULL )
+    {
+        memcpy( &(mqtt_obj->will_info), connect_info->will_info, sizeof(cy_mqtt_publish_info_t) );
+        mqtt_obj->connect_info.will_info = &(mqtt_obj->will_info);
+    }
+
+    mqtt_obj->mqtt_conn_status = true;
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_fill_outgoing_publish( cy_mqtt_object_t *mqtt_obj, uint8_t index, cy_mqtt_publish_info_t *pubmsg )
+{
+    ( void ) memset( &( mqtt_obj->outgoing_pub_packets[ index ].pubinfo ), 0x00, sizeof( MQTTPublishInfo_t ) );
+    /* cy_mqtt_qos_t and MQTTQoS_t share the values 0 to 2. */
+    mqtt_obj->outgoing_pub_packets[ index ].pubinfo.qos = (MQTTQoS_t)pubmsg->qos;
+    mqtt_obj->outgoing_pub_packets[ index ].pubinfo.retain = pubmsg->retain;
+    mqtt_obj->outgoing_pub_packets[ index ].pubinfo.pTopicName = pubmsg->topic;
+    mqtt_obj->outgoing_pub_packets[ index ].pubinfo.topicNameLength = pubmsg->topic_len;
+    mqtt_obj->outgoing_pub_packets[ index ].pubinfo.pPayload = pubmsg->payload;
+    mqtt_obj->outgoing_pub_packets[ index ].pubinfo.payloadLength = pubmsg->payload_len;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_update_ack_latency( cy_mqtt_object_t *mqtt_obj, uint32_t send_time_ms )
+{
+    uint32_t ack_latency_ms = Clock_GetTimeMs() - send_time_ms;
+
+    mqtt_obj->stats.publish_ack_count++;
+    mqtt_obj->stats.publish_ack_latency_total_ms += ack_latency_ms;
+    if( ack_latency_ms > mqtt_obj->stats.publish_ack_latency_max_ms )
+    {
+        mqtt_obj->stats.publish_ack_latency_max_ms = ack_latency_ms;
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_update_high_priority_pending( cy_mqtt_object_t *mqtt_obj, bool begin )
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    result = cy_rtos_get_mutex( &(mqtt_obj->flow_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->flow_mutex, (unsigned int)result );
+        return;
+    }
+
+    /* The event bit follows the counter under flow_mutex, so that a yielding publish wakes up when the last
+     * high-priority publish completes. */
+    if( begin == true )
+    {
+        mqtt_obj->high_priority_pending++;
+        (void)cy_rtos_clearbits_event( &(mqtt_obj->priority_event), CY_MQTT_PRIORITY_EVENT_NO_HIGH_PRIORITY, false );
+    }
+    else if( mqtt_obj->high_priority_pending > 0 )
+    {
+        mqtt_obj->high_priority_pending--;
+        if( mqtt_obj->high_priority_pending == 0 )
+        {
+            (void)cy_rtos_setbits_event( &(mqtt_obj->priority_event), CY_MQTT_PRIORITY_EVENT_NO_HIGH_PRIORITY, false );
+        }
+    }
+
+    result = cy_rtos_set_mutex( &(mqtt_obj->flow_mutex) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->flow_mutex, (unsigned int)result );
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_lock_normal_priority( cy_mqtt_object_t *mqtt_obj )
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t  bits = 0;
+
+    /* While a normal-priority publish has released process_mutex to the high-priority publishes, the mutex is
+     * meant for them only; other normal-priority senders sleep until the yield ends. */
+    while( true )
+    {
+        result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+            return result;
+        }
+        if( mqtt_obj->priority_yield_active == false )
+        {
+            return CY_RSLT_SUCCESS;
+        }
+
+        (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+        bits = CY_MQTT_PRIORITY_EVENT_NO_YIELD;
+        result = cy_rtos_waitbits_event( &(mqtt_obj->priority_event), &bits, false, true, CY_RTOS_NEVER_TIMEOUT );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_waitbits_event failed with Error : [0x%X] ", (unsigned int)result );
+            return result;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static bool mqtt_yield_to_high_priority( cy_mqtt_object_t *mqtt_obj )
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint8_t   pending = 0;
+    uint32_t  bits = 0;
+
+    /* The caller holds process_mutex. It is released at this packet boundary until the pending
+     * high-priority publishes complete, bounded by the message send timeout. Returns true if the
+     * mutex was released, in which case the caller must revalidate the session and its slots. */
+    if( cy_rtos_get_mutex( &(mqtt_obj->flow_mutex), CY_RTOS_NEVER_TIMEOUT ) != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed..! ", mqtt_obj->flow_mutex );
+        return false;
+    }
+    pending = mqtt_obj->high_priority_pending;
+    (void)cy_rtos_set_mutex( &(mqtt_obj->flow_mutex) );
+    if( pending == 0 )
+    {
+        return false;
+    }
+
+    mqtt_obj->priority_yield_active = true;
+    (void)cy_rtos_clearbits_event( &(mqtt_obj->priority_event), CY_MQTT_PRIORITY_EVENT_NO_YIELD, false );
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        mqtt_obj->priority_yield_active = false;
+        (void)cy_rtos_setbits_event( &(mqtt_obj->priority_event), CY_MQTT_PRIORITY_EVENT_NO_YIELD, false );
+        return false;
+    }
+
+    /* A publish that completed after the check above has already set the bit, so the wait returns at once. */
+    bits = CY_MQTT_PRIORITY_EVENT_NO_HIGH_PRIORITY;
+    (void)cy_rtos_waitbits_event( &(mqtt_obj->priority_event), &bits, false, true, mqtt_obj->config.message_send_timeout_ms );
+
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+    }
+    mqtt_obj->priority_yield_active = false;
+    (void)cy_rtos_setbits_event( &(mqtt_obj->priority_event), CY_MQTT_PRIORITY_EVENT_NO_YIELD, false );
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static bool mqtt_publish_survived_yield( cy_mqtt_object_t *mqtt_obj, uint8_t index, uint16_t packet_id, uint32_t discard_count )
+{
+    /* After a yield, a slot that no longer holds the packet ID was either acknowledged, or dropped without an ack by
+     * a clean reconnect or an expiry; the discard count tells the two apart. A publish still in its slot can only
+     * complete while the session is up. */
+    if( mqtt_obj->outgoing_pub_packets[ index ].packetid != packet_id )
+    {
+        return ( discard_count == mqtt_obj->outgoing_discard_count );
+    }
+    return mqtt_obj->mqtt_session_established;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_publish_message( cy_mqtt_object_t *mqtt_obj, cy_mqtt_publish_info_t *pubmsg, cy_mqtt_priority_t priority,
+                                       bool expires, uint32_t expiry_time_ms )
+{
+    cy_rslt_t        result = CY_RSLT_SUCCESS;
+    MQTTStatus_t     mqttStatus = MQTTSuccess;
+    uint8_t          publishIndex = CY_MQTT_MAX_OUTGOING_PUBLISHES;
+    uint8_t          retry = 0;
+    uint32_t         timeout = 0;
+    uint32_t         send_time_ms = 0;
+    uint16_t         packet_id = MQTT_PACKET_ID_INVALID;
+    bool             ack_received = false;
+    bool             yielded = false;
+    bool             lost = false;
+    uint32_t         discard_count = 0;
+
+    if( (pubmsg->qos != CY_MQTT_QOS0) && (pubmsg->qos != CY_MQTT_QOS1) && (pubmsg->qos != CY_MQTT_QOS2) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nQoS level not supported..!\n" );
+        return CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+    }
+
+    if( priority == CY_MQTT_PRIORITY_HIGH )
+    {
+        result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+            return result;
+        }
+    }
+    else
+    {
+        result = mqtt_lock_normal_priority( mqtt_obj );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            return result;
+        }
+        (void)mqtt_yield_to_high_priority( mqtt_obj );
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_publish - Acquired Mutex %p ", mqtt_obj->process_mutex );
+
+    /* Get the next free index for the outgoing PUBLISH packets. All QoS2 outgoing
+     * PUBLISH packets are stored until a PUBREC is received. These messages are
+     * stored for supporting a resend if a network connection is broken before
+     * receiving a PUBREC. The slot is taken under the mutex so that concurrent
+     * publishers never share a slot. */
+    result = mqtt_get_next_free_index_for_publish( mqtt_obj, priority, &publishIndex );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nUnable to find a free spot for outgoing PUBLISH message.\n" );
+        mqtt_obj->stats.publish_fail_count++;
+        (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+        return CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+    }
+
+    mqtt_fill_outgoing_publish( mqtt_obj, publishIndex, pubmsg );
+    mqtt_obj->outgoing_pub_packets[ publishIndex ].expires = expires;
+    mqtt_obj->outgoing_pub_packets[ publishIndex ].expiry_time_ms = expiry_time_ms;
+
+    /* Get a new packet ID. The event callback frees the slot when the PUBACK/PUBREC for this packet ID arrives. */
+    packet_id = MQTT_GetPacketId( &(mqtt_obj->mqtt_context) );
+    mqtt_obj->outgoing_pub_packets[ publishIndex ].packetid = packet_id;
+
+    /* Publish retry loop. */
+    do
+    {
+        /* A QoS2 PUBLISH that has been sent is kept, since the broker may already have delivered it. */
+        if( (mqtt_outgoing_publish_expired( mqtt_obj, publishIndex ) == true) &&
+            ((retry == 0) || (pubmsg->qos != CY_MQTT_QOS2)) )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nDiscarding expired PUBLISH for topic %.*s.\n", pubmsg->topic_len, pubmsg->topic );
+            if( retry == 0 )
+            {
+                (void)mqtt_cleanup_outgoing_publish( mqtt_obj, publishIndex );
+            }
+            else
+            {
+                (void)mqtt_release_outgoing_publish( mqtt_obj, publishIndex );
+            }
+            mqtt_obj->stats.expired_count++;
+            (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+            return CY_RSLT_MODULE_MQTT_EXPIRED;
+        }
+
+        if( retry > 0 )
+        {
+            mqtt_obj->stats.retry_count++;
+        }
+        timeout = mqtt_ack_timeout( mqtt_obj );
+
+        /* Send the PUBLISH packet. */
+        send_time_ms = Clock_GetTimeMs();
+        yielded = false;
+        mqttStatus = MQTT_Publish( &(mqtt_obj->mqtt_context),
+                                   &(mqtt_obj->outgoing_pub_packets[ publishIndex ].pubinfo),
+                                   packet_id );
+        if( mqttStatus != MQTTSuccess )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "Failed to send PUBLISH packet to broker with error = %s.",
+                             MQTT_Status_strerror( mqttStatus ) );
+            result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+        }
+        else
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPUBLISH sent for topic %.*s to broker with packet ID %u.\n",
+                             pubmsg->topic_len, pubmsg->topic, packet_id );
+            /* Process the incoming packet from the broker.
+             * Acknowledgment for PUBLISH ( PUBACK ) will be received here. */
+            if( pubmsg->qos != CY_MQTT_QOS0 )
+            {
+                do
+                {
+                    mqttStatus = MQTT_ProcessLoop( &(mqtt_obj->mqtt_context), CY_MQTT_RECEIVE_DATA_TIMEOUT_MS );
+                    if( mqttStatus != MQTTSuccess )
+                    {
+                        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT_ProcessLoop returned with status = %s.", MQTT_Status_strerror( mqttStatus ) );
+                        result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+                        break;
+                    }
+                    else
+                    {
+                        if( mqtt_obj->outgoing_pub_packets[ publishIndex ].packetid != packet_id )
+                        {
+                            ack_received = true;
+                            /* The ack of a retransmitted PUBLISH cannot be matched to one send, so it is not measured (Karn).
+                             * Neither is a wait that included a yield, as it measures the high-priority publishes too. */
+                            if( yielded == false )
+                            {
+                                mqtt_update_ack_latency( mqtt_obj, send_time_ms );
+                                if( retry == 0 )
+                                {
+                                    mqtt_rtt_sample( mqtt_obj, Clock_GetTimeMs() - send_time_ms );
+                                }
+                            }
+                            result = CY_RSLT_SUCCESS;
+                            break;
+                        }
+                    }
+
+                    /* Let a pending high-priority publish go ahead while this one waits for its ack. */
+                    if( priority != CY_MQTT_PRIORITY_HIGH )
+                    {
+                        discard_count = mqtt_obj->outgoing_discard_count;
+                        if( mqtt_yield_to_high_priority( mqtt_obj ) == true )
+                        {
+                            yielded = true;
+                            if( mqtt_publish_survived_yield( mqtt_obj, publishIndex, packet_id, discard_count ) == false )
+                            {
+                                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nPUBLISH with packet ID %u was dropped by a session change.\n", packet_id );
+                                lost = true;
+                                result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+                                break;
+                            }
+                            if( mqtt_obj->outgoing_pub_packets[ publishIndex ].packetid != packet_id )
+                            {
+                                /* Acknowledged while the receive thread held the mutex. */
+                                ack_received = true;
+                                result = CY_RSLT_SUCCESS;
+                                break;
+                            }
+                        }
+                    }
+
+                } while( (Clock_GetTimeMs() - send_time_ms) < timeout );
+
+                if( lost == true )
+                {
+                    break;
+                }
+
+                /* Assign the MQTT Status to an error in case of PUBACK/PUBREC receive failure to retry publish. */
+                if( ack_received == false )
+                {
+                    mqtt_obj->stats.ack_timeout_count++;
+                    mqtt_rtt_backoff( mqtt_obj );
+                    result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+                    mqttStatus = MQTTRecvFailed;
+                    mqtt_obj->outgoing_pub_packets[ publishIndex ].pubinfo.dup = true;
+                }
+            }
+            else
+            {
+                result = CY_RSLT_SUCCESS;
+            }
+        }
+        retry++;
+    } while( (mqttStatus != MQTTSuccess) && (retry < mqtt_obj->config.max_retry_value) );
+
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nFailed to send PUBLISH packet to broker with max retry..!\n " );
+        if( mqtt_obj->outgoing_pub_packets[ publishIndex ].packetid == packet_id )
+        {
+            (void)mqtt_release_outgoing_publish( mqtt_obj, publishIndex );
+        }
+        mqtt_obj->stats.publish_fail_count++;
+        (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+        return result;
+    }
+
+    mqtt_obj->stats.publish_count++;
+    mqtt_obj->stats.publish_bytes += pubmsg->payload_len;
+
+    if( pubmsg->qos == CY_MQTT_QOS0 )
+    {
+        /* Clean up outgoing_pub_packets for QoS0 PUBLISH packets.*/
+        (void)mqtt_cleanup_outgoing_publish( mqtt_obj, publishIndex );
+    }
+
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
+        return result;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_publish - Released Mutex %p ", mqtt_obj->process_mutex );
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_publish_ex( cy_mqtt_t mqtt_handle, cy_mqtt_publish_info_t *pubmsg, const cy_mqtt_publish_options_t *options )
+{
+    cy_rslt_t              result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t       *mqtt_obj;
+    cy_mqtt_publish_info_t msg;
+    char                   *encoded = NULL;
+    cy_mqtt_priority_t     priority = CY_MQTT_PRIORITY_NORMAL;
+    bool                   expires = false;
+    uint32_t               expiry_time_ms = 0;
+    bool                   notify = false;
+    cy_mqtt_event_type_t   event_type = CY_MQTT_EVENT_TYPE_RATE_HIGH_WATERMARK;
+
+    if( (mqtt_handle == NULL) || (pubmsg == NULL) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_publish()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    if( options != NULL )
+    {
+        if( (options->priority != CY_MQTT_PRIORITY_NORMAL) && (options->priority != CY_MQTT_PRIORITY_HIGH) )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid publish priority..!\n" );
+            return CY_RSLT_MODULE_MQTT_BADARG;
+        }
+        priority = options->priority;
+
+        /* The deadline is taken at the call, so that the time spent waiting for the mutex, for
+         * high-priority traffic and for acknowledgments all counts against it. */
+        if( options->expiry_ms > 0 )
+        {
+            expires = true;
+            expiry_time_ms = Clock_GetTimeMs() + options->expiry_ms;
+        }
+    }
+
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+    }
+
+    if( mqtt_obj->mqtt_session_established == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client session not present..!\n" );
+        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
+    }
+
+    /* Encode outside the process mutex so that compression does not hold up the receive thread. */
+    msg = *pubmsg;
+    result = mqtt_codec_encode( mqtt_obj, &msg, &encoded );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        mqtt_stats_add( mqtt_obj, &(mqtt_obj->stats.publish_fail_count), 1 );
+        return result;
+    }
+
+    result = mqtt_rate_acquire( mqtt_obj, msg.payload_len, (priority == CY_MQTT_PRIORITY_HIGH), &notify, &event_type );
+    if( notify == true )
+    {
+        mqtt_rate_notify( mqtt_obj, event_type );
+    }
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPublish rate limit reached for topic %.*s.\n", msg.topic_len, msg.topic );
+        mqtt_codec_release( mqtt_obj, encoded );
+        return result;
+    }
+
+    /* Announce the high-priority publish before waiting for process_mutex, so that the
+     * normal-priority publish holding it yields at its next packet boundary. */
+    if( priority == CY_MQTT_PRIORITY_HIGH )
+    {
+        mqtt_update_high_priority_pending( mqtt_obj, true );
+    }
+
+    result = mqtt_publish_message( mqtt_obj, &msg, priority, expires, expiry_time_ms );
+
+    if( priority == CY_MQTT_PRIORITY_HIGH )
+    {
+        mqtt_update_high_priority_pending( mqtt_obj, false );
+    }
+
+    /* The outgoing slot no longer references the payload once the publish has completed or failed. */
+    mqtt_codec_release( mqtt_obj, encoded );
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_publish( cy_mqtt_t mqtt_handle, cy_mqtt_publish_info_t *pubmsg )
+{
+    return cy_mqtt_publish_ex( mqtt_handle, pubmsg, NULL );
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_get_retry_after( cy_mqtt_t mqtt_handle, uint32_t *retry_after_ms )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t  *mqtt_obj;
+
+    if( (mqtt_handle == NULL) || (retry_after_ms == NULL) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_get_retry_after()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+    }
+
+    result = cy_rtos_get_mutex( &(mqtt_obj->flow_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->flow_mutex, (unsigned int)result );
+        return result;
+    }
+
+    *retry_after_ms = mqtt_obj->rate_limiter.retry_after_ms;
+
+    result = cy_rtos_set_mutex( &(mqtt_obj->flow_mutex) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->flow_mutex, (unsigned int)result );
+        return result;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_publish_latest( cy_mqtt_t mqtt_handle, cy_mqtt_publish_info_t *pubmsg )
+{
+    cy_rslt_t               result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t        *mqtt_obj;
+    cy_mqtt_coalesced_msg_t *entry = NULL;
+    char                    *buffer = NULL;
+
+    if( (mqtt_handle == NULL) || (pubmsg == NULL) || (pubmsg->topic == NULL) || (pubmsg->topic_len == 0) ||
+        ((pubmsg->payload == NULL) && (pubmsg->payload_len > 0)) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_publish_latest()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+    }
+
+    if( mqtt_obj->mqtt_session_established == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client session not present..!\n" );
+        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
+    }
+
+    /* The receive thread sends the queued values, so it must never wait for a PUBACK/PUBREC; a newer value supersedes
+     * a lost one anyway. */
+    if( pubmsg->qos != CY_MQTT_QOS0 )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nOnly QoS0 values can be queued with cy_mqtt_publish_latest()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    /* Only coalesce_mutex is taken, so the caller does not wait behind a publish in progress. */
+    result = cy_rtos_get_mutex( &(mqtt_obj->coalesce_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->coalesce_mutex, (unsigned int)result );
+        return result;
+    }
+
+    entry = mqtt_find_coalesce_entry( mqtt_obj, pubmsg->topic, pubmsg->topic_len );
+    if( entry == NULL )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nNo free entry to queue the latest value of topic %.*s..!\n", pubmsg->topic_len, pubmsg->topic );
+        result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+        goto exit;
+    }
+
+    if( (entry->topic == NULL) || (entry->topic_len != pubmsg->topic_len) ||
+        (memcmp( entry->topic, pubmsg->topic, pubmsg->topic_len ) != 0) )
+    {
+        buffer = (char *)malloc( pubmsg->topic_len );
+        if( buffer == NULL )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to queue the latest value..!\n" );
+            result = CY_RSLT_MODULE_MQTT_NOMEM;
+            goto exit;
+        }
+        free( entry->topic );
+        free( entry->payload );
+        memset( entry, 0x00, sizeof( cy_mqtt_coalesced_msg_t ) );
+        memcpy( buffer, pubmsg->topic, pubmsg->topic_len );
+        entry->topic = buffer;
+        entry->topic_len = pubmsg->topic_len;
+    }
+
+    if( pubmsg->payload_len > entry->payload_size )
+    {
+        /* Allocate before freeing so that a queued value survives an allocation failure. */
+        buffer = (char *)malloc( pubmsg->payload_len );
+        if( buffer == NULL )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to queue the latest value..!\n" );
+            result = CY_RSLT_MODULE_MQTT_NOMEM;
+            goto exit;
+        }
+        free( entry->payload );
+        entry->payload = buffer;
+        entry->payload_size = pubmsg->payload_len;
+    }
+
+    if( entry->pending == true )
+    {
+        mqtt_obj->coalesced_count++;
+    }
+
+    if( pubmsg->payload_len > 0 )
+    {
+        memcpy( entry->payload, pubmsg->payload, pubmsg->payload_len );
+    }
+    entry->payload_len = pubmsg->payload_len;
+    entry->qos = pubmsg->qos;
+    entry->retain = pubmsg->retain;
+    entry->pending = true;
+
+exit:
+    if( cy_rtos_set_mutex( &(mqtt_obj->coalesce_mutex) ) != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed..! ", mqtt_obj->coalesce_mutex );
+    }
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_batch_flush( cy_mqtt_object_t *mqtt_obj, cy_mqtt_publish_info_t *msgs, cy_rslt_t *results,
+                              uint16_t flush_to )
+{
+    uint16_t index = 0;
+
+    mqtt_obj->cork_msg_index = flush_to;
+    if( mqtt_cork_flush( mqtt_obj ) == CY_RSLT_SUCCESS )
+    {
+        return;
+    }
+
+    /* QoS0 messages have no acknowledgment; the ones staged since the last successful flush, by this flush or by one
+     * made when the staging buffer filled up, are lost. */
+    for( index = mqtt_obj->cork_unflushed_from; index < flush_to; index++ )
+    {
+        if( (msgs[ index ].qos == CY_MQTT_QOS0) && (results[ index ] == CY_RSLT_SUCCESS) )
+        {
+            results[ index ] = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+            mqtt_obj->stats.publish_count--;
+            mqtt_obj->stats.publish_bytes -= msgs[ index ].payload_len;
+            mqtt_obj->stats.publish_fail_count++;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static uint8_t mqtt_batch_collect_acks( cy_mqtt_object_t *mqtt_obj, cy_mqtt_publish_info_t *msgs, cy_rslt_t *results,
+                                        cy_mqtt_batch_entry_t *window, uint8_t window_count,
+                                        bool measure_latency, bool measure_rtt )
+{
+    uint8_t index = 0;
+    uint8_t acked = 0;
+
+    /* A slot that no longer holds the packet ID of its message was freed by the PUBACK/PUBREC. */
+    for( index = 0; index < window_count; index++ )
+    {
+        if( (window[ index ].acked == false) &&
+            (mqtt_obj->outgoing_pub_packets[ window[ index ].slot ].packetid != window[ index ].packetid) )
+        {
+            window[ index ].acked = true;
+            acked++;
+            if( measure_latency == true )
+            {
+                mqtt_update_ack_latency( mqtt_obj, window[ index ].send_time_ms );
+            }
+            if( measure_rtt == true )
+            {
+                mqtt_rtt_sample( mqtt_obj, Clock_GetTimeMs() - window[ index ].send_time_ms );
+            }
+            results[ window[ index ].msg_index ] = CY_RSLT_SUCCESS;
+            mqtt_obj->stats.publish_count++;
+            mqtt_obj->stats.publish_bytes += msgs[ window[ index ].msg_index ].payload_len;
+        }
+    }
+    return acked;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static uint8_t mqtt_batch_drop_lost( cy_mqtt_object_t *mqtt_obj, cy_mqtt_batch_entry_t *window, uint8_t window_count,
+                                     uint32_t discard_count )
+{
+    uint8_t index = 0;
+    uint8_t dropped = 0;
+
+    /* Stop waiting for the messages that a session change during the yield has made impossible to acknowledge. */
+    for( index = 0; index < window_count; index++ )
+    {
+        if( (window[ index ].acked == false) &&
+            (mqtt_publish_survived_yield( mqtt_obj, window[ index ].slot, window[ index ].packetid, discard_count ) == false) )
+        {
+            if( mqtt_obj->outgoing_pub_packets[ window[ index ].slot ].packetid == window[ index ].packetid )
+            {
+                (void)mqtt_release_outgoing_publish( mqtt_obj, window[ index ].slot );
+            }
+            window[ index ].acked = true;
+            dropped++;
+            mqtt_obj->stats.publish_fail_count++;
+        }
+    }
+    return dropped;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_batch_link_lost( cy_mqtt_object_t *mqtt_obj, cy_mqtt_batch_entry_t *window, uint8_t window_count,
+                                  uint16_t unsent )
+{
+    cy_mqtt_event_t event;
+    cy_rslt_t       result = CY_RSLT_SUCCESS;
+    uint8_t         index = 0;
+
+    /* The caller must hold process_mutex. A failed or partial send has left the stream out of step with the broker,
+     * so the session is ended as on link loss and the rest of the batch fails. */
+    for( index = 0; index < window_count; index++ )
+    {
+        if( window[ index ].acked == false )
+        {
+            if( mqtt_obj->outgoing_pub_packets[ window[ index ].slot ].packetid == window[ index ].packetid )
+            {
+                (void)mqtt_release_outgoing_publish( mqtt_obj, window[ index ].slot );
+            }
+            window[ index ].acked = true;
+            mqtt_obj->stats.publish_fail_count++;
+        }
+    }
+    mqtt_obj->stats.publish_fail_count += unsent;
+
+    if( mqtt_obj->mqtt_session_established == false )
+    {
+        return;
+    }
+
+    memset( &event, 0x00, sizeof(cy_mqtt_event_t) );
+    event.type = CY_MQTT_EVENT_TYPE_DISCONNECT;
+    event.data.reason = CY_MQTT_DISCONN_TYPE_NETWORK_DOWN;
+    if( mqtt_obj->mqtt_event_cb != NULL )
+    {
+        mqtt_obj->mqtt_event_cb( (cy_mqtt_t)mqtt_obj, event, mqtt_obj->user_data );
+    }
+    mqtt_obj->mqtt_session_established = false;
+
+    if( mqtt_obj->auto_reconnect == true )
+    {
+        /* The socket layer may not report a link that is still open, so hand the handle to the disconnect event thread. */
+        result = cy_rtos_put_queue( &mqtt_disconnect_event_queue, (void *)&mqtt_obj, CY_MQTT_DISCONNECT_EVENT_QUEUE_TIMEOUT_IN_MSEC, false );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nPushing to disconnect event queue failed with Error : [0x%X] ", (unsigned int)result );
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static bool mqtt_batch_rate_acquire( cy_mqtt_object_t *mqtt_obj, size_t payload_len, bool *notify, cy_mqtt_event_type_t *event_type )
+{
+    bool                  crossed = false;
+    cy_mqtt_event_type_t  crossed_type = CY_MQTT_EVENT_TYPE_RATE_HIGH_WATERMARK;
+    cy_rslt_t             result = CY_RSLT_SUCCESS;
+
+    /* The watermark events alternate, so two crossings within a batch cancel out; only the net change is
+     * notified, once cy_mqtt_publish_batch has released process_mutex. */
+    result = mqtt_rate_acquire( mqtt_obj, payload_len, false, &crossed, &crossed_type );
+    if( crossed == true )
+    {
+        *notify = !(*notify);
+        *event_type = crossed_type;
+    }
+    return ( result == CY_RSLT_SUCCESS );
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_publish_batch_internal( cy_mqtt_object_t *mqtt_obj, cy_mqtt_publish_info_t *msgs, uint16_t count,
+                                         cy_rslt_t *results, uint8_t *send_buffer,
+                                         bool *notify, cy_mqtt_event_type_t *event_type )
+{
+    MQTTStatus_t      mqttStatus = MQTTSuccess;
+    MQTTPublishInfo_t qos0_info;
+    uint16_t          next = 0;
+    uint16_t          index = 0;
+    uint8_t           slot = 0;
+    uint8_t           window_count = 0;
+    uint8_t           pending = 0;
+    uint8_t           retry = 0;
+    uint32_t          timeout = 0;
+    uint32_t          wait_start_ms = 0;
+    uint32_t          discard_count = 0;
+    bool              yielded = false;
+    cy_mqtt_batch_entry_t window[ CY_MQTT_MAX_OUTGOING_PUBLISHES ];
+
+    /* The caller must hold process_mutex. */
+    mqtt_obj->cork_failed = false;
+    mqtt_obj->cork_unflushed_from = 0;
+    while( next < count )
+    {
+        (void)mqtt_yield_to_high_priority( mqtt_obj );
+
+        /* Serialize messages back to back until every outgoing PUBLISH slot is waiting for an ack. */
+        mqtt_obj->cork_buffer = send_buffer;
+        window_count = 0;
+        while( (next < count) && (mqtt_obj->cork_failed == false) )
+        {
+            if( (msgs[ next ].qos != CY_MQTT_QOS0) && (msgs[ next ].qos != CY_MQTT_QOS1) && (msgs[ next ].qos != CY_MQTT_QOS2) )
+            {
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nQoS level not supported for batch message %u..!\n", (unsigned int)next );
+                mqtt_obj->stats.publish_fail_count++;
+                next++;
+                continue;
+            }
+
+            if( msgs[ next ].qos == CY_MQTT_QOS0 )
+            {
+                if( mqtt_batch_rate_acquire( mqtt_obj, msgs[ next ].payload_len, notify, event_type ) == false )
+                {
+                    results[ next ] = CY_RSLT_MODULE_MQTT_WOULD_BLOCK;
+                    next++;
+                    continue;
+                }
+
+                memset( &qos0_info, 0x00, sizeof(qos0_info) );
+                qos0_info.qos = MQTTQoS0;
+                qos0_info.retain = msgs[ next ].retain;
+                qos0_info.pTopicName = msgs[ next ].topic;
+                qos0_info.topicNameLength = msgs[ next ].topic_len;
+                qos0_info.pPayload = msgs[ next ].payload;
+                qos0_info.payloadLength = msgs[ next ].payload_len;
+                mqtt_obj->cork_msg_index = next;
+                mqttStatus = MQTT_Publish( &(mqtt_obj->mqtt_context), &qos0_info, MQTT_PACKET_ID_INVALID );
+                if( mqttStatus == MQTTSuccess )
+                {
+                    results[ next ] = CY_RSLT_SUCCESS;
+                    mqtt_obj->stats.publish_count++;
+                    mqtt_obj->stats.publish_bytes += msgs[ next ].payload_len;
+                }
+                else
+                {
+                    mqtt_obj->stats.publish_fail_count++;
+                }
+                next++;
+                continue;
+            }
+
+            if( mqtt_get_next_free_index_for_publish( mqtt_obj, CY_MQTT_PRIORITY_NORMAL, &slot ) != CY_RSLT_SUCCESS )
+            {
+                break;
+            }
+
+            if( mqtt_batch_rate_acquire( mqtt_obj, msgs[ next ].payload_len, notify, event_type ) == false )
+            {
+                results[ next ] = CY_RSLT_MODULE_MQTT_WOULD_BLOCK;
+                next++;
+                continue;
+            }
+
+            /* Batch messages take no expiry, so a resend after the session is resumed never discards them. */
+            mqtt_fill_outgoing_publish( mqtt_obj, slot, &msgs[ next ] );
+            mqtt_obj->outgoing_pub_packets[ slot ].expires = false;
+            mqtt_obj->outgoing_pub_packets[ slot ].packetid = MQTT_GetPacketId( &(mqtt_obj->mqtt_context) );
+            window[ window_count ].msg_index = next;
+            window[ window_count ].slot = slot;
+            window[ window_count ].packetid = mqtt_obj->outgoing_pub_packets[ slot ].packetid;
+            window[ window_count ].send_time_ms = Clock_GetTimeMs();
+            window[ window_count ].acked = false;
+
+            mqtt_obj->cork_msg_index = next;
+            mqttStatus = MQTT_Publish( &(mqtt_obj->mqtt_context), &(mqtt_obj->outgoing_pub_packets[ slot ].pubinfo), window[ window_count ].packetid );
+            if( mqttStatus != MQTTSuccess )
+            {
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "Failed to send PUBLISH packet to broker with error = %s.", MQTT_Status_strerror( mqttStatus ) );
+                (void)mqtt_release_outgoing_publish( mqtt_obj, slot );
+                mqtt_obj->stats.publish_fail_count++;
+            }
+            else
+            {
+                window_count++;
+            }
+            next++;
+        }
+
+        mqtt_batch_flush( mqtt_obj, msgs, results, next );
+        mqtt_obj->cork_buffer = NULL;
+        if( mqtt_obj->cork_failed == true )
+        {
+            mqtt_batch_link_lost( mqtt_obj, window, window_count, (uint16_t)(count - next) );
+            return;
+        }
+
+        if( (window_count == 0) && (next < count) )
+        {
+            /* All the slots are held by unacknowledged publishes from a previous session. */
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nUnable to find a free spot for outgoing PUBLISH message.\n" );
+            mqtt_obj->stats.publish_fail_count++;
+            next++;
+            continue;
+        }
+
+        /* Collect the acks of the whole window, resending the unacknowledged messages together. */
+        retry = 0;
+        pending = window_count;
+        while( (pending > 0) && (retry < mqtt_obj->config.max_retry_value) )
+        {
+            if( retry > 0 )
+            {
+                mqtt_obj->cork_buffer = send_buffer;
+                for( index = 0; index < window_count; index++ )
+                {
+                    if( window[ index ].acked == false )
+                    {
+                        mqtt_obj->stats.retry_count++;
+                        mqtt_obj->outgoing_pub_packets[ window[ index ].slot ].pubinfo.dup = true;
+                        window[ index ].send_time_ms = Clock_GetTimeMs();
+                        mqttStatus = MQTT_Publish( &(mqtt_obj->mqtt_context), &(mqtt_obj->outgoing_pub_packets[ window[ index ].slot ].pubinfo), window[ index ].packetid );
+                        if( mqttStatus != MQTTSuccess )
+                        {
+                            /* Left unacknowledged; given up on with the window once the retries run out. */
+                            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "Failed to resend PUBLISH packet with packet ID %u, error = %s.",
+                                             window[ index ].packetid, MQTT_Status_strerror( mqttStatus ) );
+                        }
+                    }
+                }
+                mqtt_obj->cork_msg_index = next;
+                (void)mqtt_cork_flush( mqtt_obj );
+                mqtt_obj->cork_buffer = NULL;
+                if( mqtt_obj->cork_failed == true )
+                {
+                    mqtt_batch_link_lost( mqtt_obj, window, window_count, (uint16_t)(count - next) );
+                    return;
+                }
+            }
+
+            /* The wait is bounded by the clock, since a MQTT_ProcessLoop call may block for longer than one poll. */
+            timeout = mqtt_ack_timeout( mqtt_obj );
+            wait_start_ms = Clock_GetTimeMs();
+            yielded = false;
+            do
+            {
+                mqttStatus = MQTT_ProcessLoop( &(mqtt_obj->mqtt_context), CY_MQTT_RECEIVE_DATA_TIMEOUT_MS );
+                if( mqttStatus != MQTTSuccess )
+                {
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT_ProcessLoop returned with status = %s.", MQTT_Status_strerror( mqttStatus ) );
+                    break;
+                }
+
+                /* Acks of retransmitted messages (Karn) and waits that included a yield are not measured. */
+                pending -= mqtt_batch_collect_acks( mqtt_obj, msgs, results, window, window_count,
+                                                    (yielded == false), ((yielded == false) && (retry == 0)) );
+                if( pending == 0 )
+                {
+                    break;
+                }
+                discard_count = mqtt_obj->outgoing_discard_count;
+                if( mqtt_yield_to_high_priority( mqtt_obj ) == true )
+                {
+                    yielded = true;
+                    pending -= mqtt_batch_drop_lost( mqtt_obj, window, window_count, discard_count );
+                    pending -= mqtt_batch_collect_acks( mqtt_obj, msgs, results, window, window_count, false, false );
+                    if( pending == 0 )
+                    {
+                        break;
+                    }
+                }
+            } while( (Clock_GetTimeMs() - wait_start_ms) < timeout );
+
+            if( pending > 0 )
+            {
+                mqtt_obj->stats.ack_timeout_count++;
+                mqtt_rtt_backoff( mqtt_obj );
+            }
+            retry++;
+        }
+
+        for( index = 0; index < window_count; index++ )
+        {
+            if( window[ index ].acked == false )
+            {
+                (void)mqtt_release_outgoing_publish( mqtt_obj, window[ index ].slot );
+                mqtt_obj->stats.publish_fail_count++;
+            }
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_codec_release_batch( cy_mqtt_object_t *mqtt_obj, uint16_t count,
+                                      cy_mqtt_publish_info_t *encoded_msgs, char **encoded_bufs )
+{
+    uint16_t index = 0;
+
+    if( encoded_bufs != NULL )
+    {
+        for( index = 0; index < count; index++ )
+        {
+            mqtt_codec_release( mqtt_obj, encoded_bufs[ index ] );
+        }
+        free( encoded_bufs );
+    }
+    if( encoded_msgs != NULL )
+    {
+        free( encoded_msgs );
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_codec_encode_batch( cy_mqtt_object_t *mqtt_obj, cy_mqtt_publish_info_t *msgs, uint16_t count,
+                                          cy_mqtt_publish_info_t **encoded_msgs, char ***encoded_bufs )
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint16_t  index = 0;
+
+    *encoded_msgs = (cy_mqtt_publish_info_t *)malloc( count * sizeof( cy_mqtt_publish_info_t ) );
+    *encoded_bufs = (char **)calloc( count, sizeof( char * ) );
+    if( (*encoded_msgs == NULL) || (*encoded_bufs == NULL) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to encode batch..!\n" );
+        mqtt_codec_release_batch( mqtt_obj, count, *encoded_msgs, *encoded_bufs );
+        *encoded_msgs = NULL;
+        *encoded_bufs = NULL;
+        return CY_RSLT_MODULE_MQTT_NOMEM;
+    }
+
+    /* Encode the whole batch up front; a batch is sent only if every payload could be encoded. */
+    for( index = 0; index < count; index++ )
+    {
+        (*encoded_msgs)[ index ] = msgs[ index ];
+        result = mqtt_codec_encode( mqtt_obj, &(*encoded_msgs)[ index ], &(*encoded_bufs)[ index ] );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            mqtt_stats_add( mqtt_obj, &(mqtt_obj->stats.publish_fail_count), count );
+            mqtt_codec_release_batch( mqtt_obj, count, *encoded_msgs, *encoded_bufs );
+            *encoded_msgs = NULL;
+            *encoded_bufs = NULL;
+            return result;
+        }
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_publish_batch( cy_mqtt_t mqtt_handle, cy_mqtt_publish_info_t *msgs, uint16_t count, cy_rslt_t *results )
+{
+    cy_rslt_t              result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t       *mqtt_obj;
+    uint8_t                *send_buffer = NULL;
+    uint16_t               index = 0;
+    cy_mqtt_publish_info_t *encoded_msgs = NULL;
+    char                   **encoded_bufs = NULL;
+    bool                   notify = false;
+    cy_mqtt_event_type_t   event_type = CY_MQTT_EVENT_TYPE_RATE_HIGH_WATERMARK;
+
+    if( (mqtt_handle == NULL) || (msgs == NULL) || (results == NULL) || (count < 1) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_publish_batch()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+    }
+
+    if( mqtt_obj->mqtt_session_established == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client session not present..!\n" );
+        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
     }
 
-    if( bufflen < CY_MQTT_MIN_NETWORK_BUFFER_SIZE )
+    for( index = 0; index < count; index++ )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBuffer length is less then minimun network buffer size : %u..!\n", (uint16_t)CY_MQTT_MIN_NETWORK_BUFFER_SIZE );
-        return CY_RSLT_MODULE_MQTT_BADARG;
+        results[ index ] = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
     }
 
-    if( (mqtt_lib_init_status == false) || (mqtt_db_mutex_init_status == false) )
+    send_buffer = (uint8_t *)malloc( CY_MQTT_BATCH_SEND_BUFFER_SIZE );
+    if( send_buffer == NULL )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nLibrary init is not done/Global mutex is not initialized..!\n " );
-        return CY_RSLT_MODULE_MQTT_CREATE_FAIL;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to create batch send buffer..!\n" );
+        return CY_RSLT_MODULE_MQTT_NOMEM;
     }
 
-    result = cy_rtos_get_mutex( &mqtt_db_mutex, CY_RTOS_NEVER_TIMEOUT );
+    if( mqtt_obj->codec.encode != NULL )
+    {
+        result = mqtt_codec_encode_batch( mqtt_obj, msgs, count, &encoded_msgs, &encoded_bufs );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            free( send_buffer );
+            return result;
+        }
+        msgs = encoded_msgs;
+    }
+
+    result = mqtt_lock_normal_priority( mqtt_obj );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
+        mqtt_codec_release_batch( mqtt_obj, count, encoded_msgs, encoded_bufs );
+        free( send_buffer );
         return result;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_create - Acquired Mutex %p ", mqtt_db_mutex );
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_publish_batch - Acquired Mutex %p ", mqtt_obj->process_mutex );
 
-    if( mqtt_handle_count >= CY_MQTT_MAX_HANDLE )
+    mqtt_publish_batch_internal( mqtt_obj, msgs, count, results, send_buffer, &notify, &event_type );
+
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nNumber of created mqtt object exceeds %d..!\n", CY_MQTT_MAX_HANDLE );
-        (void)cy_rtos_set_mutex( &mqtt_db_mutex );
-        return CY_RSLT_MODULE_MQTT_CREATE_FAIL;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
     }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_publish_batch - Released Mutex %p ", mqtt_obj->process_mutex );
+    mqtt_codec_release_batch( mqtt_obj, count, encoded_msgs, encoded_bufs );
+    free( send_buffer );
 
-    result = cy_rtos_set_mutex( &mqtt_db_mutex );
+    if( notify == true )
+    {
+        mqtt_rate_notify( mqtt_obj, event_type );
+    }
+
+    /* A failure takes precedence over a rate limit refusal in the overall result. */
+    for( index = 0; index < count; index++ )
+    {
+        if( results[ index ] == CY_RSLT_MODULE_MQTT_PUBLISH_FAIL )
+        {
+            return CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+        }
+        if( results[ index ] != CY_RSLT_SUCCESS )
+        {
+            result = results[ index ];
+        }
+    }
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_packer_init( cy_mqtt_packer_t *packer, cy_mqtt_t mqtt_handle, const char *topic, uint16_t topic_len,
+                               cy_mqtt_qos_t qos, uint8_t *buffer, size_t buffer_size, uint32_t max_age_ms )
+{
+    if( (packer == NULL) || (mqtt_handle == NULL) || (topic == NULL) || (topic_len == 0) || (buffer == NULL) ||
+        (buffer_size <= CY_MQTT_PACKER_LENGTH_PREFIX_SIZE) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_packer_init()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    if( (qos != CY_MQTT_QOS0) && (qos != CY_MQTT_QOS1) && (qos != CY_MQTT_QOS2) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nQoS level not supported..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    memset( packer, 0x00, sizeof( cy_mqtt_packer_t ) );
+    packer->mqtt_handle = mqtt_handle;
+    packer->topic = topic;
+    packer->topic_len = topic_len;
+    packer->qos = qos;
+    packer->buffer = buffer;
+    packer->buffer_size = buffer_size;
+    packer->max_age_ms = max_age_ms;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_packer_flush( cy_mqtt_packer_t *packer )
+{
+    cy_rslt_t              result = CY_RSLT_SUCCESS;
+    cy_mqtt_publish_info_t pub_msg;
+
+    if( (packer == NULL) || (packer->buffer == NULL) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_packer_flush()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    if( packer->used == 0 )
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    memset( &pub_msg, 0x00, sizeof( cy_mqtt_publish_info_t ) );
+    pub_msg.qos = packer->qos;
+    pub_msg.topic = packer->topic;
+    pub_msg.topic_len = packer->topic_len;
+    pub_msg.payload = (const char *)packer->buffer;
+    pub_msg.payload_len = packer->used;
+
+    result = cy_mqtt_publish( packer->mqtt_handle, &pub_msg );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nFailed to publish %u packed samples with Error : [0x%X] ", (unsigned int)packer->sample_count, (unsigned int)result );
         return result;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_create - Released Mutex %p ", mqtt_db_mutex );
 
-    mqtt_obj = (cy_mqtt_object_t *)malloc( sizeof( cy_mqtt_object_t ) );
-    if( mqtt_obj == NULL )
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPublished %u packed samples in %u bytes.\n", (unsigned int)packer->sample_count, (unsigned int)packer->used );
+    packer->used = 0;
+    packer->sample_count = 0;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_packer_poll( cy_mqtt_packer_t *packer )
+{
+    if( packer == NULL )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to create MQTT object..!\n" );
-        return CY_RSLT_MODULE_MQTT_NOMEM;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_packer_poll()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_obj : %p..!\n", mqtt_obj );
 
-    /* Clear the MQTT handle data. */
-    memset( mqtt_obj, 0x00, sizeof( cy_mqtt_object_t ) );
+    if( (packer->used > 0) && (packer->max_age_ms > 0) &&
+        ((Clock_GetTimeMs() - packer->first_sample_time_ms) >= packer->max_age_ms) )
+    {
+        return cy_mqtt_packer_flush( packer );
+    }
 
-    mqtt_obj->mqtt_obj_initialized = false;
-    if( security != NULL )
+    return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_packer_add( cy_mqtt_packer_t *packer, const void *sample, uint16_t sample_len )
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if( (packer == NULL) || (packer->buffer == NULL) || ((sample == NULL) && (sample_len > 0)) ||
+        (((size_t)sample_len + CY_MQTT_PACKER_LENGTH_PREFIX_SIZE) > packer->buffer_size) )
     {
-        mqtt_obj->security.alpnprotos = security->alpnprotos;
-        mqtt_obj->security.alpnprotoslen = security->alpnprotoslen;
-        mqtt_obj->security.sni_host_name = security->sni_host_name;
-        mqtt_obj->security.sni_host_name_size = security->sni_host_name_size;
-        mqtt_obj->security.username = security->username;
-        mqtt_obj->security.username_size = security->username_size;
-        mqtt_obj->security.password = security->password;
-        mqtt_obj->security.password_size = security->password_size;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_packer_add()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
 
-        mqtt_obj->security.client_cert = security->client_cert;
-        mqtt_obj->security.client_cert_size = security->client_cert_size;
-        mqtt_obj->security.private_key = security->private_key;
-        mqtt_obj->security.private_key_size = security->private_key_size;
-        mqtt_obj->security.root_ca = security->root_ca;
-        mqtt_obj->security.root_ca_size = security->root_ca_size;
-        mqtt_obj->mqtt_secure_mode = true;
+    if( (packer->used + CY_MQTT_PACKER_LENGTH_PREFIX_SIZE + sample_len) > packer->buffer_size )
+    {
+        result = cy_mqtt_packer_flush( packer );
+        if( result != CY_RSLT_SUCCESS )
+        {
+            return result;
+        }
     }
-    else
+
+    if( packer->used == 0 )
     {
-        mqtt_obj->mqtt_secure_mode = false;
+        packer->first_sample_time_ms = Clock_GetTimeMs();
     }
 
-    mqtt_obj->server_info.host_name = broker_info->hostname;
-    mqtt_obj->server_info.port = broker_info->port;
-    mqtt_obj->mqtt_event_cb = event_callback;
-    mqtt_obj->user_data = user_data;
+    packer->buffer[ packer->used ] = (uint8_t)( sample_len >> 8 );
+    packer->buffer[ packer->used + 1 ] = (uint8_t)( sample_len & 0xFFU );
+    if( sample_len > 0 )
+    {
+        memcpy( &(packer->buffer[ packer->used + CY_MQTT_PACKER_LENGTH_PREFIX_SIZE ]), sample, sample_len );
+    }
+    packer->used += CY_MQTT_PACKER_LENGTH_PREFIX_SIZE + sample_len;
+    packer->sample_count++;
+
+    /* The sample is buffered at this point; a failed age flush is retried on the next add or poll. */
+    (void)cy_mqtt_packer_poll( packer );
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+bool cy_mqtt_unpack_next( const char *payload, size_t payload_len, size_t *offset, const char **sample, uint16_t *sample_len )
+{
+    uint16_t len = 0;
+
+    if( (payload == NULL) || (offset == NULL) || (sample == NULL) || (sample_len == NULL) )
+    {
+        return false;
+    }
+
+    if( (*offset + CY_MQTT_PACKER_LENGTH_PREFIX_SIZE) > payload_len )
+    {
+        return false;
+    }
+
+    len = (uint16_t)( ((uint16_t)(uint8_t)payload[ *offset ] << 8) | (uint8_t)payload[ *offset + 1 ] );
+    if( (*offset + CY_MQTT_PACKER_LENGTH_PREFIX_SIZE + len) > payload_len )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nTruncated packed payload at offset %u..!\n", (unsigned int)*offset );
+        return false;
+    }
+
+    *sample = &payload[ *offset + CY_MQTT_PACKER_LENGTH_PREFIX_SIZE ];
+    *sample_len = len;
+    *offset += CY_MQTT_PACKER_LENGTH_PREFIX_SIZE + len;
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_subscribe_internal( cy_mqtt_object_t *mqtt_obj, cy_mqtt_subscribe_info_t *sub_info, uint8_t sub_count )
+{
+    cy_rslt_t              result = CY_RSLT_SUCCESS;
+    MQTTStatus_t           mqttStatus;
+    uint8_t                index = 0, retry = 0;
+    MQTTSubscribeInfo_t    *sub_list = NULL;
+    uint32_t               timeout = 0;
+    uint32_t               send_time_ms = 0;
+
+    /* The caller must hold process_mutex. */
+    sub_list = (MQTTSubscribeInfo_t *)malloc( (sizeof(MQTTSubscribeInfo_t) * sub_count) );
+    if( sub_list == NULL )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to create sub_list..!\n" );
+        return CY_RSLT_MODULE_MQTT_NOMEM;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nsub_list : %p..!\n", sub_list );
+
+    for( index = 0; index < sub_count; index++ )
+    {
+        if( sub_info[index].qos == CY_MQTT_QOS0 )
+        {
+            sub_list[ index ].qos = MQTTQoS0;
+        }
+        else if( sub_info[index].qos == CY_MQTT_QOS1 )
+        {
+            sub_list[ index ].qos = MQTTQoS1;
+        }
+        else if( sub_info[index].qos == CY_MQTT_QOS2 )
+        {
+            sub_list[ index ].qos = MQTTQoS2;
+        }
+        else
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nQoS not supported..!\n" );
+            free( sub_list );
+            return CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
+        }
+        sub_info[ index ].allocated_qos = CY_MQTT_QOS_INVALID;
+        sub_list[ index ].pTopicFilter = sub_info[index].topic;
+        sub_list[ index ].topicFilterLength = sub_info[index].topic_len;
+    }
+
+    /* Generate the packet identifier for the SUBSCRIBE packet. */
+    mqtt_obj->sent_packet_id = MQTT_GetPacketId( &(mqtt_obj->mqtt_context) );
+
+    do
+    {
+        if( retry > 0 )
+        {
+            mqtt_obj->stats.retry_count++;
+        }
+        timeout = mqtt_ack_timeout( mqtt_obj );
+        result = CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
+        memset( &mqtt_obj->sub_ack_status, 0x00, sizeof(mqtt_obj->sub_ack_status) );
+
+        /*
+         * num_of_subs_in_req is initialized with number of subscribe messages in one MQTT subscribe request.
+         * Once after receiving the subscription acknowledgment this variable is set to zero.
+         * So num_of_subs_in_req == 0 refers that there is no outstanding subscription messages waiting for acknowledgment. */
+        mqtt_obj->num_of_subs_in_req = sub_count;
+
+        /* Send the SUBSCRIBE packet. */
+        send_time_ms = Clock_GetTimeMs();
+        mqttStatus = MQTT_Subscribe( &(mqtt_obj->mqtt_context),
+                                     sub_list,
+                                     sub_count,
+                                     mqtt_obj->sent_packet_id );
+        if( mqttStatus != MQTTSuccess )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nFailed to send SUBSCRIBE packet to broker with error = %s.",
+                             MQTT_Status_strerror( mqttStatus ) );
+            result = CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
+        }
+        else
+        {
+            for( index = 0; index < sub_count; index++ )
+            {
+                mqtt_obj->sub_ack_status[index] = MQTTSubAckFailure;
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nSUBSCRIBE sent for topic %.*s to broker.\n",
+                                 sub_list[ index ].topicFilterLength,
+                                 sub_list[ index ].pTopicFilter );
+            }
+            do
+            {
+                /* Process the incoming packet from the broker.
+                 * Acknowledgment for subscription ( SUBACK ) will be received here. */
+                mqttStatus = MQTT_ProcessLoop( &(mqtt_obj->mqtt_context), CY_MQTT_RECEIVE_DATA_TIMEOUT_MS );
+                if( mqttStatus != MQTTSuccess )
+                {
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT_ProcessLoop returned with status = %s.", MQTT_Status_strerror( mqttStatus ) );
+                    result = CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
+                    break;
+                }
+
+                /* if suback status is updated then num_of_subs_in_req will be set to 0 in mqtt_event_callback.*/
+                if( mqtt_obj->num_of_subs_in_req == 0 )
+                {
+                    if( retry == 0 )
+                    {
+                        mqtt_rtt_sample( mqtt_obj, Clock_GetTimeMs() - send_time_ms );
+                    }
+                    result = CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL; /* Initialize result with failure. */
+                    for( index = 0; index < sub_count; index++ )
+                    {
+                        if( mqtt_obj->sub_ack_status[index] == MQTTSubAckFailure )
+                        {
+                            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nMQTT broker rejected SUBSCRIBE request for topic %.*s .\n",
+                                             sub_list[ index ].topicFilterLength,
+                                             sub_list[ index ].pTopicFilter );
+                            sub_info[ index ].allocated_qos = CY_MQTT_QOS_INVALID;
+                        }
+                        else
+                        {
+                            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nSUBSCRIBE accepted for topic %.*s with QoS %d .\n",
+                                             sub_list[ index ].topicFilterLength,
+                                             sub_list[ index ].pTopicFilter, mqtt_obj->sub_ack_status[index] );
+                            if( mqtt_obj->sub_ack_status[index] == MQTTSubAckSuccessQos0 )
+                            {
+                                sub_info[ index ].allocated_qos = CY_MQTT_QOS0;
+                            }
+                            else if( mqtt_obj->sub_ack_status[index] == MQTTSubAckSuccessQos1 )
+                            {
+                                sub_info[ index ].allocated_qos = CY_MQTT_QOS1;
+                            }
+                            else
+                            {
+                                sub_info[ index ].allocated_qos = CY_MQTT_QOS2;
+                            }
+                            result = CY_RSLT_SUCCESS; /* Update with success if at least one subscription is successful. */
+                        }
+                    }
+                    break; /* Received the ack. So exit timeout do loop */
+                }
+            } while( (Clock_GetTimeMs() - send_time_ms) < timeout );
 
-    if( user_data == NULL )
-    {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nArgument user_data is NULL..!\n" );
-    }
+            if( mqtt_obj->num_of_subs_in_req != 0 )
+            {
+                mqtt_obj->stats.ack_timeout_count++;
+                mqtt_rtt_backoff( mqtt_obj );
+                result = CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
+                mqttStatus = MQTTRecvFailed; /* Assign error value to retry subscribe. */
+            }
+        }
+        retry++;
+    } while( (mqttStatus != MQTTSuccess) && (retry < mqtt_obj->config.max_retry_value) );
 
-    result = cy_rtos_init_mutex2( &(mqtt_obj->process_mutex), false );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCreating new mutex %p. failed", mqtt_obj->process_mutex );
-        goto exit;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nSubscription ack status is MQTTSubAckFailure..!\n" );
     }
 
-    process_mutex_init_status = true;
+    free( sub_list );
+    return result;
+}
 
-    result = mqtt_initialize_core_lib( &(mqtt_obj->mqtt_context), &(mqtt_obj->network_context), buffer, bufflen );
-    if( result != CY_RSLT_SUCCESS )
-    {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nmqtt_initialize_core_lib failed with Error : [0x%X] ", (unsigned int)result );
-        goto exit;
-    }
-    else
-    {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nmqtt_initialize_core_lib successful." );
-    }
+/*----------------------------------------------------------------------------------------------------------*/
 
-    mqtt_obj->network_context.disconnect_info.cbf = mqtt_awsport_network_disconnect_callback;
-    mqtt_obj->network_context.disconnect_info.user_data = ( void * )mqtt_obj;
+cy_rslt_t cy_mqtt_subscribe( cy_mqtt_t mqtt_handle, cy_mqtt_subscribe_info_t *sub_info, uint8_t sub_count  )
+{
+    cy_rslt_t              result = CY_RSLT_SUCCESS;
+    cy_rslt_t              res = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t       *mqtt_obj;
+    uint8_t                index = 0;
 
-    result = cy_rtos_get_mutex( &mqtt_db_mutex, CY_RTOS_NEVER_TIMEOUT );
-    if( result != CY_RSLT_SUCCESS )
+    if( (mqtt_handle == NULL) || (sub_info == NULL) || (sub_count < 1) || (sub_count > CY_MQTT_MAX_OUTGOING_SUBSCRIBES) )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
-        goto exit;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_subscribe()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_create - Acquired Mutex %p ", mqtt_db_mutex );
-
-    slot_index = 0;
-    slot_found = false;
 
-    while( slot_index < CY_MQTT_MAX_HANDLE )
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
     {
-        if( mqtt_handle_database[slot_index].mqtt_handle == NULL )
-        {
-            mqtt_handle_database[slot_index].mqtt_handle = (void *)mqtt_obj;
-            mqtt_handle_database[slot_index].mqtt_context = &(mqtt_obj->mqtt_context);
-            slot_found = true;
-            break;
-        }
-        slot_index++;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
     }
 
-    if( slot_found == false )
+    if( mqtt_obj->mqtt_session_established == false )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\n Free slot not available for new handle..!\n" );
-        (void)cy_rtos_set_mutex( &mqtt_db_mutex );
-        result = CY_RSLT_MODULE_MQTT_CREATE_FAIL;
-        goto exit;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client session not present..!\n" );
+        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
     }
 
-    mqtt_obj->mqtt_obj_initialized = true;
-    mqtt_obj->mqtt_obj_index = slot_index;
-    *mqtt_handle = (void *)mqtt_obj;
-    mqtt_handle_count++;
+    if( sub_count > CY_MQTT_MAX_OUTGOING_SUBSCRIBES )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMax number of supported subscription count in single request is %d\n", (int)CY_MQTT_MAX_OUTGOING_SUBSCRIBES );
+        return CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
+    }
 
-    result = cy_rtos_set_mutex( &mqtt_db_mutex );
+    result = mqtt_lock_normal_priority( mqtt_obj );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
-        goto exit;
+        return result;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_create - Released Mutex %p ", mqtt_db_mutex );
-
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nMQTT object created successfully..\n" );
-    return CY_RSLT_SUCCESS;
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_subscribe - Acquired Mutex %p ", mqtt_obj->process_mutex );
 
-exit :
-    if( mqtt_obj != NULL )
+    result = mqtt_subscribe_internal( mqtt_obj, sub_info, sub_count );
+    if( (result == CY_RSLT_SUCCESS) && (mqtt_obj->auto_reconnect == true) )
     {
-        if( process_mutex_init_status == true )
+        for( index = 0; index < sub_count; index++ )
         {
-            (void)cy_rtos_deinit_mutex( &(mqtt_obj->process_mutex) );
-            process_mutex_init_status = false;
+            if( sub_info[ index ].allocated_qos != CY_MQTT_QOS_INVALID )
+            {
+                (void)mqtt_track_subscription( mqtt_obj, &sub_info[ index ] );
+            }
         }
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\n Free mqtt_obj : %p..!\n", mqtt_obj );
-        free( mqtt_obj );
     }
 
+    res = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( res != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)res );
+        return res;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_subscribe - Released Mutex %p ", mqtt_obj->process_mutex );
+
     return result;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-cy_rslt_t cy_mqtt_connect( cy_mqtt_t mqtt_handle, cy_mqtt_connect_info_t *connect_info )
+cy_rslt_t cy_mqtt_unsubscribe( cy_mqtt_t mqtt_handle, cy_mqtt_unsubscribe_info_t *unsub_info, uint8_t unsub_count )
 {
-    cy_rslt_t                     result = CY_RSLT_SUCCESS;
-    cy_rslt_t                     res = CY_RSLT_SUCCESS;
-    RetryUtilsParams_t            reconnectParams;
-    MQTTStatus_t                  mqttStatus = MQTTSuccess;
-    RetryUtilsStatus_t            retryUtilsStatus = RetryUtilsSuccess;
-    cy_mqtt_object_t              *mqtt_obj;
-    bool                          create_clean_session = false;
-    MQTTConnectInfo_t             connect_details;
-    MQTTPublishInfo_t             will_msg_details;
-    MQTTPublishInfo_t             *will_msg_ptr = NULL;
-    cy_awsport_ssl_credentials_t  *security = NULL;
+    cy_rslt_t              result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t       *mqtt_obj;
+    MQTTStatus_t           mqttStatus;
+    uint8_t                index = 0, retry = 0;
+    MQTTSubscribeInfo_t    *unsub_list = NULL;
+    uint32_t               timeout = 0;
+    uint32_t               send_time_ms = 0;
 
-    if( mqtt_handle == NULL )
+    if( (mqtt_handle == NULL) || (unsub_info == NULL) || (unsub_count < 1) )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_connect()..!\n" );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_unsubscribe()..!\n" );
         return CY_RSLT_MODULE_MQTT_BADARG;
     }
 
@@ -1145,439 +4679,431 @@ cy_rslt_t cy_mqtt_connect( cy_mqtt_t mqtt_handle, cy_mqtt_connect_info_t *connec
         return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
     }
 
-    memset( &connect_details, 0x00, sizeof( MQTTConnectInfo_t ) );
-    memset( &will_msg_details, 0x00, sizeof( MQTTPublishInfo_t ) );
+    if( mqtt_obj->mqtt_session_established == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client session not present..!\n" );
+        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
+    }
 
-    /* Connect Information */
-    connect_details.cleanSession = connect_info->clean_session;
-    connect_details.keepAliveSeconds = connect_info->keep_alive_sec;
-    connect_details.pClientIdentifier = connect_info->client_id;
-    connect_details.clientIdentifierLength = connect_info->client_id_len;
-    connect_details.pPassword = connect_info->password;
-    connect_details.passwordLength = connect_info->password_len;
-    connect_details.pUserName = connect_info->username;
-    connect_details.userNameLength = connect_info->username_len;
+    if( unsub_count > CY_MQTT_MAX_OUTGOING_SUBSCRIBES )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMax number of supported unsubscription count in single request is %d\n", (int)CY_MQTT_MAX_OUTGOING_SUBSCRIBES );
+        return CY_RSLT_MODULE_MQTT_UNSUBSCRIBE_FAIL;
+    }
 
-    if( connect_info->will_info != NULL )
+    unsub_list = (MQTTSubscribeInfo_t *)malloc( (sizeof(MQTTSubscribeInfo_t) * unsub_count) );
+    if( unsub_list == NULL )
     {
-        /* Will information. */
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nWill info is not NULL ..!\n" );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to create unsub_list..!\n" );
+        return CY_RSLT_MODULE_MQTT_NOMEM;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nsub_list : %p..!\n", unsub_list );
 
-        if( connect_info->will_info->qos > CY_MQTT_QOS2 )
-        {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid Will msg QoS..!\n" );
-            return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
-        }
-        if( (connect_info->will_info->dup != true) && (connect_info->will_info->dup != false) )
-        {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid Will msg dup..!\n" );
-            return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
-        }
-        if( (connect_info->will_info->retain != true) && (connect_info->will_info->retain != false) )
+    for( index = 0; index < unsub_count; index++ )
+    {
+        if( unsub_info[index].qos == CY_MQTT_QOS0 )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid Will msg retain..!\n" );
-            return CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+            unsub_list[ index ].qos = MQTTQoS0;
         }
-
-        if( connect_info->will_info->qos == CY_MQTT_QOS0 )
+        else if( unsub_info[index].qos == CY_MQTT_QOS1 )
         {
-            will_msg_details.qos = MQTTQoS0;
+            unsub_list[ index ].qos = MQTTQoS1;
         }
-        else if( connect_info->will_info->qos == CY_MQTT_QOS1 )
+        else if( unsub_info[index].qos == CY_MQTT_QOS2 )
         {
-            will_msg_details.qos = MQTTQoS1;
+            unsub_list[ index ].qos = MQTTQoS2;
         }
         else
         {
-            will_msg_details.qos = MQTTQoS2;
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nQoS level not supported...\n" );
+            free( unsub_list );
+            return CY_RSLT_MODULE_MQTT_UNSUBSCRIBE_FAIL;
         }
-
-        will_msg_details.dup = connect_info->will_info->dup;
-        will_msg_details.retain = connect_info->will_info->retain;
-        will_msg_details.pTopicName = connect_info->will_info->topic;
-        will_msg_details.topicNameLength = connect_info->will_info->topic_len;
-        will_msg_details.pPayload = connect_info->will_info->payload;
-        will_msg_details.payloadLength = connect_info->will_info->payload_len;
-        will_msg_ptr = &will_msg_details;
-    }
-    else
-    {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nWill info is NULL ..!\n" );
-        will_msg_ptr = NULL;
+        unsub_list[ index ].pTopicFilter = unsub_info[index].topic;
+        unsub_list[ index ].topicFilterLength = unsub_info[index].topic_len;
     }
 
-    /* Initialize the reconnect attempts and interval. */
-    RetryUtils_ParamsReset( &reconnectParams );
-
-    if( mqtt_obj->mqtt_secure_mode == true )
-    {
-        security = &(mqtt_obj->security);
-    }
-    else
+    result = mqtt_lock_normal_priority( mqtt_obj );
+    if( result != CY_RSLT_SUCCESS )
     {
-        security = NULL;
+        free( unsub_list );
+        return result;
     }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_unsubscribe - Acquired Mutex %p ", mqtt_obj->process_mutex );
+
+    /* Generate the packet identifier for the UNSUBSCRIBE packet. */
+    mqtt_obj->sent_packet_id = MQTT_GetPacketId( &(mqtt_obj->mqtt_context) );
 
-    /* Attempt to connect to an MQTT broker. If connection fails, retry after
-     * a timeout. The timeout value will exponentially increase until the maximum
-     * attempts are reached.
-     */
     do
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nCreating MQTT socket..\n" );
-        result = cy_awsport_network_create( &(mqtt_obj->network_context), &(mqtt_obj->server_info), security, &(mqtt_obj->network_context.disconnect_info) );
-        if ( result != CY_RSLT_SUCCESS )
+        if( retry > 0 )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_awsport_network_create failed with Error : [0x%X] ", (unsigned int)result );
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nConnection to the broker failed. Retrying connection with backoff and jitter.\n" );
-            retryUtilsStatus = RetryUtils_BackoffAndSleep( &reconnectParams );
+            mqtt_obj->stats.retry_count++;
+        }
+        timeout = mqtt_ack_timeout( mqtt_obj );
+        mqtt_obj->unsub_ack_received = false;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "UNSUBSCRIBE sent for topic %.*s to broker.\n\n", unsub_info->topic_len, unsub_info->topic );
+        /* Send the UNSUBSCRIBE packet. */
+        send_time_ms = Clock_GetTimeMs();
+        mqttStatus = MQTT_Unsubscribe( &(mqtt_obj->mqtt_context),
+                                       unsub_list,
+                                       unsub_count,
+                                       mqtt_obj->sent_packet_id );
+        if( mqttStatus != MQTTSuccess )
+        {
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "Failed to send UNSUBSCRIBE packet to broker with error = %s.",
+                        MQTT_Status_strerror( mqttStatus ) );
+            result = CY_RSLT_MODULE_MQTT_UNSUBSCRIBE_FAIL;
         }
         else
         {
-            /* Establish a TLS session with the MQTT broker. */
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "Establishing a TLS session to %.*s:%d.",
-                             strlen(mqtt_obj->server_info.host_name), mqtt_obj->server_info.host_name, mqtt_obj->server_info.port );
-            result = cy_awsport_network_connect( &(mqtt_obj->network_context),
-                                                 CY_MQTT_MESSAGE_SEND_TIMEOUT_MS,
-                                                 CY_MQTT_SOCKET_RECEIVE_TIMEOUT_MS );
-            if( result != CY_RSLT_SUCCESS )
+            do
             {
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nConnection to the broker failed. Retrying connection with backoff and jitter.\n" );
-
-                retryUtilsStatus = RetryUtils_BackoffAndSleep( &reconnectParams );
-                (void)cy_awsport_network_delete( &(mqtt_obj->network_context) );
-                /*
-                 * In case of an unexpected network disconnection, the cy_awsport_network_delete API always returns failure. Therefore,
-                 * the return value of the cy_awsport_network_delete API is not checked here.
-                 */
-                /* Fall-through. */
-            }
+                /* Process the  incoming packet from the broker.
+                 * Acknowledgment for UNSUBSCRIBE ( UNSUBACK ) will be received here. */
+                mqttStatus = MQTT_ProcessLoop( &(mqtt_obj->mqtt_context), CY_MQTT_RECEIVE_DATA_TIMEOUT_MS );
+                if( mqttStatus != MQTTSuccess )
+                {
+                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT_ProcessLoop returned with status = %s.", MQTT_Status_strerror( mqttStatus ) );
+                    result = CY_RSLT_MODULE_MQTT_UNSUBSCRIBE_FAIL;
+                    break;
+                }
+                if( mqtt_obj->unsub_ack_received == true )
+                {
+                    if( retry == 0 )
+                    {
+                        mqtt_rtt_sample( mqtt_obj, Clock_GetTimeMs() - send_time_ms );
+                    }
+                    result = CY_RSLT_SUCCESS;
+                    break;
+                }
+            } while( (Clock_GetTimeMs() - send_time_ms) < timeout );
 
-            if( retryUtilsStatus == RetryUtilsRetriesExhausted )
+            if( mqtt_obj->unsub_ack_received == false )
             {
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nConnection to the broker failed, all attempts exhausted.\n" );
-                result = CY_RSLT_MODULE_MQTT_CONNECT_FAIL;
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nNot received unsuback before timeout %u millisecond ", (unsigned int)mqtt_ack_timeout( mqtt_obj ) );
+                mqtt_obj->stats.ack_timeout_count++;
+                mqtt_rtt_backoff( mqtt_obj );
+                result = CY_RSLT_MODULE_MQTT_UNSUBSCRIBE_FAIL;
+                mqttStatus = MQTTRecvFailed; /* Assign error value to retry subscribe. */
             }
         }
-
-    } while( ( result != CY_RSLT_SUCCESS ) && ( retryUtilsStatus == RetryUtilsSuccess ) );
+        retry++;
+    } while( (mqttStatus != MQTTSuccess) && (retry < mqtt_obj->config.max_retry_value) );
 
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nTLS connection failed with Error : [0x%X] ", (unsigned int)result );
-        return result;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nSubscription ack status is MQTTSubAckFailure..!\n" );
+        goto exit;
     }
 
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nTLS connection established ..\n" );
-
-    create_clean_session = (connect_details.cleanSession == true ) ? false : true;
-    if( create_clean_session == true )
+    for( index = 0; index < unsub_count; index++ )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nCreating clean session ..\n" );
+        mqtt_untrack_subscription( mqtt_obj, &unsub_info[ index ] );
     }
 
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nCreating an MQTT connection to %.*s.",
-                     strlen(mqtt_obj->server_info.host_name), mqtt_obj->server_info.host_name );
-
-    /* Sends an MQTT Connect packet using the established TLS session. */
-    result = mqtt_establish_session( mqtt_obj, &connect_details, will_msg_ptr, create_clean_session, &(mqtt_obj->broker_session_present) );
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nEstablish MQTT session failed with Error : [0x%X] ", (unsigned int)result );
-        goto exit;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
+        free( unsub_list );
+        return result;
     }
-    else
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_unsubscribe - Released Mutex %p ", mqtt_obj->process_mutex );
+
+    /* Free unsub_list. */
+    free( unsub_list );
+    return CY_RSLT_SUCCESS;
+
+exit :
+    (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    /* Free unsub_list. */
+    if( unsub_list != NULL )
     {
-        if( mqtt_obj->recv_thread == NULL )
-        {
-            char th_name[32];
-            static uint8_t thread_sno = 0;
+        free( unsub_list );
+    }
 
-            snprintf( th_name, sizeof(th_name), "%d%s", ++thread_sno, " -MQTTReceive\n"  );
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nCreating MQTT Receive thread......\n" );
-            mqtt_obj->recv_thread = NULL;
-            result = cy_rtos_create_thread( &mqtt_obj->recv_thread,
-                                            mqtt_receive_thread,
-                                            th_name,
-                                            NULL,
-                                            CY_MQTT_RECEIVE_THREAD_STACK_SIZE,
-                                            CY_MQTT_RECEIVE_THREAD_PRIORITY,
-                                            (cy_thread_arg_t)mqtt_obj );
-            if( result != CY_RSLT_SUCCESS )
-            {
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT receive thread creation failed with Error : [0x%X] ", (unsigned int)result );
-                goto exit;
-            }
-        }
+    return result;
+}
 
-        if( (mqtt_obj->broker_session_present == true) && (create_clean_session == false) )
+/*----------------------------------------------------------------------------------------------------------*/
+
+static cy_rslt_t mqtt_restore_subscriptions( cy_mqtt_object_t *mqtt_obj )
+{
+    cy_rslt_t                 result = CY_RSLT_SUCCESS;
+    cy_rslt_t                 res = CY_RSLT_SUCCESS;
+    cy_mqtt_subscribe_info_t  sub_info[ CY_MQTT_MAX_OUTGOING_SUBSCRIBES ];
+    uint8_t                   sub_count = 0;
+    uint8_t                   index = 0;
+
+    /* The caller must hold process_mutex. */
+    for( index = 0; index < CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS; index++ )
+    {
+        if( mqtt_obj->tracked_subs[ index ].topic != NULL )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nMQTT session with broker is re-established. Resending unacked publishes." );
-            /* Handle all resend of PUBLISH messages. */
-            result = mqtt_handle_publish_resend( mqtt_obj );
-            if( result != CY_RSLT_SUCCESS )
-            {
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nHandle all the resend of PUBLISH messages failed with Error : [0x%X] ", (unsigned int)result );
-                goto exit;
-            }
+            sub_info[ sub_count ].qos = mqtt_obj->tracked_subs[ index ].qos;
+            sub_info[ sub_count ].topic = mqtt_obj->tracked_subs[ index ].topic;
+            sub_info[ sub_count ].topic_len = mqtt_obj->tracked_subs[ index ].topic_len;
+            sub_info[ sub_count ].allocated_qos = CY_MQTT_QOS_INVALID;
+            sub_count++;
         }
-        else
-        {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\n A clean MQTT connection is established. Cleaning up all the stored outgoing publishes." );
 
-            /* Clean up the outgoing PUBLISH packets and wait for ack because this new
-             * connection does not re-establish an existing session. */
-            result = mqtt_cleanup_outgoing_publishes( mqtt_obj );
-            if( result != CY_RSLT_SUCCESS )
+        /* Send the topics in as few SUBSCRIBE packets as possible. */
+        if( (sub_count == CY_MQTT_MAX_OUTGOING_SUBSCRIBES) ||
+            ((sub_count > 0) && (index == (CY_MQTT_MAX_TRACKED_SUBSCRIPTIONS - 1))) )
+        {
+            res = mqtt_subscribe_internal( mqtt_obj, sub_info, sub_count );
+            if( res != CY_RSLT_SUCCESS )
             {
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCleaning of PUBLISH messages failed with Error : [0x%X] ", (unsigned int)result );
-                goto exit;
+                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nRestoring subscriptions failed with Error : [0x%X] ", (unsigned int)res );
+                result = res;
             }
+            sub_count = 0;
         }
     }
 
-    mqtt_obj->mqtt_conn_status = true;
     return result;
+}
 
-exit :
+/*----------------------------------------------------------------------------------------------------------*/
 
-    if( mqtt_obj->mqtt_session_established == true )
-    {
-        mqttStatus = MQTT_Disconnect( &(mqtt_obj->mqtt_context) );
-        if( mqttStatus != MQTTSuccess )
-        {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "Sending MQTT DISCONNECT failed with status=%s.",
-                             MQTT_Status_strerror( mqttStatus ) );
-            /*
-             * In case of an unexpected network disconnection, the MQTT_Disconnect API always returns failure. Therefore,
-             * the return value of the MQTT_Disconnect API is not checked here.
-             */
-            /* Fall-through. */
-        }
-        mqtt_obj->mqtt_session_established = false;
-    }
+static uint32_t mqtt_reconnect_jitter( cy_mqtt_object_t *mqtt_obj )
+{
+    uint32_t  state = mqtt_obj->jitter_state;
+    uint16_t  index = 0;
 
-    if( mqtt_obj->recv_thread != NULL )
+    if( state == 0 )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nTerminating MQTT receive thread %p..!\n", mqtt_obj->recv_thread );
-        res = cy_rtos_terminate_thread( &mqtt_obj->recv_thread  );
-        if( res != CY_RSLT_SUCCESS )
+        /* Devices running the same firmware would draw the same sequence from a fixed seed, so the seed is a hash
+         * (FNV-1a) of the client identifier, which the broker requires to be unique, mixed with the uptime. */
+        state = 2166136261U;
+        for( index = 0; index < mqtt_obj->connect_info.client_id_len; index++ )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nTerminate MQTT receive thread failed with Error : [0x%X] ", (unsigned int)result );
-            /*
-             * In case of an unexpected thread failure, the cy_rtos_terminate_thread API always returns failure. Therefore,
-             * the return value of the cy_rtos_terminate_thread API is not checked here.
-             */
-            /* Fall-through. */
+            state ^= (uint8_t)mqtt_obj->connect_info.client_id[ index ];
+            state *= 16777619U;
         }
-
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nJoining MQTT receive thread %p..!\n", mqtt_obj->recv_thread );
-        res = cy_rtos_join_thread( &mqtt_obj->recv_thread );
-        if( res != CY_RSLT_SUCCESS )
+        state ^= Clock_GetTimeMs();
+        if( state == 0 )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nJoin MQTT receive thread failed with Error : [0x%X] ", (unsigned int)result );
-            /*
-             * In case of an unexpected thread failure, the cy_rtos_join_thread API always returns failure. Therefore,
-             * the return value of the cy_rtos_join_thread API is not checked here.
-             */
-            /* Fall-through. */
+            state = 1;
         }
-        mqtt_obj->recv_thread = NULL;
     }
 
-    res = cy_awsport_network_disconnect( &(mqtt_obj->network_context) );
-    if( res != CY_RSLT_SUCCESS )
-    {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_awsport_network_disconnect failed with Error : [0x%X] ", (unsigned int)result );
-        /*
-         * In case of an unexpected network disconnection, the cy_awsport_network_disconnect API always returns failure. Therefore,
-         * the return value of the cy_awsport_network_disconnect API is not checked here.
-         */
-        /* Fall-through. */
-    }
-    res = cy_awsport_network_delete( &(mqtt_obj->network_context) );
-    if( res != CY_RSLT_SUCCESS )
-    {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_awsport_network_delete failed with Error : [0x%X] ", (unsigned int)result );
-        /*
-         * In case of an unexpected network disconnection, the cy_awsport_network_delete API always returns failure. Therefore,
-         * the return value of the cy_awsport_network_delete API is not checked here.
-         */
-        /* Fall-through. */
-    }
+    /* xorshift32; the state is per handle, so the generator is not shared with the application or other handles. */
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    mqtt_obj->jitter_state = state;
 
-    return result;
+    return state;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-cy_rslt_t cy_mqtt_publish( cy_mqtt_t mqtt_handle, cy_mqtt_publish_info_t *pubmsg )
+static void mqtt_reconnect_backoff( cy_mqtt_object_t *mqtt_obj, uint32_t *backoff_ms )
 {
-    cy_rslt_t        result = CY_RSLT_SUCCESS;
-    MQTTStatus_t     mqttStatus = MQTTSuccess;
-    uint8_t          publishIndex = CY_MQTT_MAX_OUTGOING_PUBLISHES;
-    cy_mqtt_object_t *mqtt_obj;
-    uint8_t          retry = 0;
-    uint32_t         timeout = 0;
+    uint32_t  delay_ms = 0;
+    uint32_t  slept_ms = 0;
 
-    if( (mqtt_handle == NULL) || (pubmsg == NULL) )
+    /* Sleep for a random time between half and all of the current backoff, so that devices that lost the broker at the
+     * same time do not reconnect in step. The sleep is cut short when the application disconnects. */
+    delay_ms = (*backoff_ms / 2) + ( mqtt_reconnect_jitter( mqtt_obj ) % ( (*backoff_ms / 2) + 1 ) );
+    while( (slept_ms < delay_ms) && (mqtt_obj->auto_reconnect == true) && (mqtt_obj->mqtt_conn_status == true) )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_publish()..!\n" );
-        return CY_RSLT_MODULE_MQTT_BADARG;
+        cy_rtos_delay_milliseconds( CY_MQTT_RECONNECT_POLL_INTERVAL_MS );
+        slept_ms += CY_MQTT_RECONNECT_POLL_INTERVAL_MS;
     }
 
-    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
-    if( mqtt_obj->mqtt_obj_initialized == false )
+    if( *backoff_ms < (CY_MQTT_RECONNECT_BACKOFF_MAX_MS / 2) )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
-        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+        *backoff_ms = *backoff_ms * 2;
     }
-
-    if( mqtt_obj->mqtt_session_established == false )
+    else
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client session not present..!\n" );
-        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
+        *backoff_ms = CY_MQTT_RECONNECT_BACKOFF_MAX_MS;
     }
+}
 
-    /* Get the next free index for the outgoing PUBLISH packets. All QoS2 outgoing
-     * PUBLISH packets are stored until a PUBREC is received. These messages are
-     * stored for supporting a resend if a network connection is broken before
-     * receiving a PUBREC. */
-    result = mqtt_get_next_free_index_for_publish( mqtt_obj, &publishIndex );
+/*----------------------------------------------------------------------------------------------------------*/
+
+static void mqtt_auto_reconnect( cy_thread_arg_t arg )
+{
+    cy_rslt_t            result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t     *mqtt_obj = (cy_mqtt_object_t *)arg;
+    cy_mqtt_event_t      event;
+    uint32_t             backoff_ms = 0;
+    bool                 connected = false;
+
+    /* reconnect_in_progress was set by the disconnect event thread; it keeps cy_mqtt_disconnect and cy_mqtt_delete
+     * off the handle until it is cleared at the end of this thread. */
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nUnable to find a free spot for outgoing PUBLISH message.\n" );
-        return CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        mqtt_obj->reconnect_in_progress = false;
+        cy_rtos_exit_thread();
+        return;
     }
-    else
+
+    /* A link lost again while the subscriptions are being restored is reported while this thread is still running,
+     * so the disconnect event thread does not start another reconnect for it; it is handled by the next pass. */
+    while( (mqtt_obj->auto_reconnect == true) && (mqtt_obj->mqtt_conn_status == true) &&
+           (mqtt_obj->mqtt_session_established == false) )
     {
-        if( (pubmsg->qos == CY_MQTT_QOS0) || (pubmsg->qos == CY_MQTT_QOS1) || (pubmsg->qos == CY_MQTT_QOS2) )
-        {
-            mqtt_obj->outgoing_pub_packets[ publishIndex ].pubinfo.qos = (MQTTQoS_t)pubmsg->qos;
-        }
-        else
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nMQTT connection lost. Reconnecting to the broker..\n" );
+        (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+        mqtt_teardown_session( mqtt_obj );
+
+        /* mqtt_connect_session tries each endpoint once; the attempts are spaced here only, with exponential backoff
+         * and random jitter. Keep trying at the maximum backoff until the application disconnects or disables the
+         * automatic reconnect. */
+        connected = false;
+        backoff_ms = CY_MQTT_RECONNECT_BACKOFF_BASE_MS;
+        while( (mqtt_obj->auto_reconnect == true) && (mqtt_obj->mqtt_conn_status == true) )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nQoS level not supported..!\n" );
-            return CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+            result = mqtt_connect_session( mqtt_obj, &(mqtt_obj->connect_info), false );
+            if( result == CY_RSLT_SUCCESS )
+            {
+                connected = true;
+                break;
+            }
+
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nReconnect failed with Error : [0x%X]. Retrying with backoff and jitter.\n", (unsigned int)result );
+            mqtt_stats_add( mqtt_obj, &(mqtt_obj->stats.connect_retry_count), 1 );
+            mqtt_reconnect_backoff( mqtt_obj, &backoff_ms );
         }
-        mqtt_obj->outgoing_pub_packets[ publishIndex ].pubinfo.pTopicName = pubmsg->topic;
-        mqtt_obj->outgoing_pub_packets[ publishIndex ].pubinfo.topicNameLength = pubmsg->topic_len;
-        mqtt_obj->outgoing_pub_packets[ publishIndex ].pubinfo.pPayload = pubmsg->payload;
-        mqtt_obj->outgoing_pub_packets[ publishIndex ].pubinfo.payloadLength = pubmsg->payload_len;
 
         result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+        if( (result == CY_RSLT_SUCCESS) && (connected == true) && (mqtt_obj->mqtt_conn_status == false) )
+        {
+            /* The application called cy_mqtt_disconnect while the reconnect was in progress; it waits for the link to be closed here.
+             * The session is torn down without process_mutex, which the receive thread needs in order to exit. */
+            (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+            mqtt_teardown_session( mqtt_obj );
+            connected = false;
+            result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+        }
         if( result != CY_RSLT_SUCCESS )
         {
             cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
-            return result;
+            mqtt_obj->reconnect_in_progress = false;
+            cy_rtos_exit_thread();
+            return;
         }
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_publish - Acquired Mutex %p ", mqtt_obj->process_mutex );
 
-        /* Get a new packet ID. */
-        mqtt_obj->outgoing_pub_packets[ publishIndex ].packetid = MQTT_GetPacketId( &(mqtt_obj->mqtt_context) );
-        mqtt_obj->pub_ack_status.packetid = mqtt_obj->outgoing_pub_packets[ publishIndex ].packetid;
-        /* Publish retry loop. */
-        do
+        if( connected == true )
         {
-            mqtt_obj->pub_ack_status.puback_status = false;
-            timeout = CY_MQTT_ACK_RECEIVE_TIMEOUT_MS;
+            memset( &event, 0x00, sizeof(cy_mqtt_event_t) );
+            event.type = CY_MQTT_EVENT_TYPE_RECONNECTED;
 
-            /* Send the PUBLISH packet. */
-            mqttStatus = MQTT_Publish( &(mqtt_obj->mqtt_context),
-                                       &(mqtt_obj->outgoing_pub_packets[ publishIndex ].pubinfo),
-                                       mqtt_obj->outgoing_pub_packets[ publishIndex ].packetid );
-            if( mqttStatus != MQTTSuccess )
+            /* A resumed broker session keeps the subscriptions; unacknowledged publishes are already resent by mqtt_connect_session. */
+            if( (mqtt_obj->broker_session_present == false) || (mqtt_obj->connect_info.clean_session == true) )
             {
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "Failed to send PUBLISH packet to broker with error = %s.",
-                                 MQTT_Status_strerror( mqttStatus ) );
-                result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+                result = mqtt_restore_subscriptions( mqtt_obj );
+                if( result != CY_RSLT_SUCCESS )
+                {
+                    event.type = CY_MQTT_EVENT_TYPE_RESUBSCRIBE_FAIL;
+                }
             }
-            else
+
+            mqtt_obj->stats.reconnect_count++;
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nMQTT connection re-established..\n" );
+
+            if( mqtt_obj->mqtt_event_cb != NULL )
             {
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nPUBLISH sent for topic %.*s to broker with packet ID %u.\n",
-                                 pubmsg->topic_len, pubmsg->topic, mqtt_obj->outgoing_pub_packets[ publishIndex ].packetid );
-                /* Process the incoming packet from the broker.
-                 * Acknowledgment for PUBLISH ( PUBACK ) will be received here. */
-                if( mqtt_obj->outgoing_pub_packets[ publishIndex ].pubinfo.qos != MQTTQoS0 )
-                {
-                    do
-                    {
-                        mqttStatus = MQTT_ProcessLoop( &(mqtt_obj->mqtt_context), CY_MQTT_RECEIVE_DATA_TIMEOUT_MS );
-                        if( mqttStatus != MQTTSuccess )
-                        {
-                            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT_ProcessLoop returned with status = %s.", MQTT_Status_strerror( mqttStatus ) );
-                            result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
-                            break;
-                        }
-                        else
-                        {
-                            if( mqtt_obj->pub_ack_status.puback_status == true )
-                            {
-                                result = CY_RSLT_SUCCESS;
-                                break;
-                            }
-                        }
+                mqtt_obj->mqtt_event_cb( (cy_mqtt_t)mqtt_obj, event, mqtt_obj->user_data );
+            }
+        }
+    }
 
-                        timeout = timeout - CY_MQTT_SOCKET_RECEIVE_TIMEOUT_MS;
+    mqtt_obj->reconnect_in_progress = false;
 
-                    } while( timeout > 0 );
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+    }
 
-                    /* Assign the MQTT Status to an error in case of PUBACK/PUBREC receive failure to retry publish. */
-                    if( mqtt_obj->pub_ack_status.puback_status == false )
-                    {
-                        result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
-                        mqttStatus = MQTTRecvFailed;
-                    }
-                }
-                else
-                {
-                    result = CY_RSLT_SUCCESS;
-                }
-                mqtt_obj->outgoing_pub_packets[ publishIndex ].pubinfo.dup = true;
-            }
-            retry++;
-        } while( (mqttStatus != MQTTSuccess) && (retry < CY_MQTT_MAX_RETRY_VALUE) );
+    cy_rtos_exit_thread();
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_disconnect( cy_mqtt_t mqtt_handle )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t  *mqtt_obj;
+
+    if( mqtt_handle == NULL )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_disconnect()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+    }
+
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_disconnect - Acquiring Mutex %p ", mqtt_obj->process_mutex );
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return result;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_disconnect - Acquired Mutex %p ", mqtt_obj->process_mutex );
 
-        if( result != CY_RSLT_SUCCESS )
-        {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nFailed to send PUBLISH packet to broker with max retry..!\n " );
-            mqtt_cleanup_outgoing_publish( mqtt_obj, publishIndex );
-            (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
-            return result;
-        }
+    if( mqtt_obj->mqtt_conn_status == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client not connected..!\n" );
+        (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
+    }
 
-        if( mqtt_obj->outgoing_pub_packets[ publishIndex ].pubinfo.qos == MQTTQoS0 )
+    if( mqtt_obj->reconnect_in_progress == true )
+    {
+        /* The reconnect thread owns the link; it closes the link once it sees that the application has disconnected.
+         * Wait for it to finish, so that the handle can be deleted as soon as this function returns. */
+        mqtt_obj->mqtt_conn_status = false;
+        (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+        while( mqtt_obj->reconnect_in_progress == true )
         {
-            /* Clean up outgoing_pub_packets for QoS0 PUBLISH packets.*/
-            (void)mqtt_cleanup_outgoing_publish( mqtt_obj, publishIndex );
+            cy_rtos_delay_milliseconds( CY_MQTT_RECONNECT_POLL_INTERVAL_MS );
         }
+        return CY_RSLT_SUCCESS;
+    }
 
-        result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
-        if( result != CY_RSLT_SUCCESS )
-        {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
-            return result;
-        }
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_publish - Released Mutex %p ", mqtt_obj->process_mutex );
+    /* Cleared first so that a link failure reported from now on does not start an automatic reconnect. */
+    mqtt_obj->mqtt_conn_status = false;
+
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_disconnect - Releasing Mutex %p ", mqtt_obj->process_mutex );
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
+        return result;
     }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_disconnect - Released Mutex %p ", mqtt_obj->process_mutex );
+
+    /* Stops the receive thread, sends DISCONNECT and closes the link. */
+    mqtt_teardown_session( mqtt_obj );
 
     return result;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-cy_rslt_t cy_mqtt_subscribe( cy_mqtt_t mqtt_handle, cy_mqtt_subscribe_info_t *sub_info, uint8_t sub_count  )
+cy_rslt_t cy_mqtt_delete( cy_mqtt_t mqtt_handle )
 {
-    cy_rslt_t              result = CY_RSLT_SUCCESS;
-    MQTTStatus_t           mqttStatus;
-    cy_mqtt_object_t       *mqtt_obj;
-    uint8_t                index = 0, retry = 0;
-    MQTTSubscribeInfo_t    *sub_list = NULL;
-    uint32_t               timeout = 0;
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t  *mqtt_obj;
 
-    if( (mqtt_handle == NULL) || (sub_info == NULL) || (sub_count < 1) || (sub_count > CY_MQTT_MAX_OUTGOING_SUBSCRIBES) )
+    if( mqtt_handle == NULL )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_subscribe()..!\n" );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_delete()..!\n" );
         return CY_RSLT_MODULE_MQTT_BADARG;
     }
 
@@ -1588,197 +5114,188 @@ cy_rslt_t cy_mqtt_subscribe( cy_mqtt_t mqtt_handle, cy_mqtt_subscribe_info_t *su
         return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
     }
 
-    if( mqtt_obj->mqtt_session_established == false )
-    {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client session not present..!\n" );
-        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
-    }
-
-    if( sub_count > CY_MQTT_MAX_OUTGOING_SUBSCRIBES )
+    if( mqtt_obj->mqtt_conn_status == true )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMax number of supported subscription count in single request is %d\n", (int)CY_MQTT_MAX_OUTGOING_SUBSCRIBES );
-        return CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
+        /* Deleting a connected handle would leak the receive thread and the network socket. */
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client is connected. Call cy_mqtt_disconnect before deleting the handle..!\n" );
+        return CY_RSLT_MODULE_MQTT_DELETE_FAIL;
     }
 
-    sub_list = (MQTTSubscribeInfo_t *)malloc( (sizeof(MQTTSubscribeInfo_t) * sub_count) );
-    if( sub_list == NULL )
+    if( mqtt_obj->reconnect_in_progress == true )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to create sub_list..!\n" );
-        return CY_RSLT_MODULE_MQTT_NOMEM;
+        /* The reconnect thread still references the handle. */
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT automatic reconnect in progress. Call cy_mqtt_disconnect before deleting the handle..!\n" );
+        return CY_RSLT_MODULE_MQTT_DELETE_FAIL;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nsub_list : %p..!\n", sub_list );
 
-    for( index = 0; index < sub_count; index++ )
+    if( mqtt_obj->reconnect_thread != NULL )
     {
-        if( sub_info[index].qos == CY_MQTT_QOS0 )
-        {
-            sub_list[ index ].qos = MQTTQoS0;
-        }
-        else if( sub_info[index].qos == CY_MQTT_QOS1 )
-        {
-            sub_list[ index ].qos = MQTTQoS1;
-        }
-        else if( sub_info[index].qos == CY_MQTT_QOS2 )
-        {
-            sub_list[ index ].qos = MQTTQoS2;
-        }
-        else
+        result = cy_rtos_join_thread( &mqtt_obj->reconnect_thread );
+        if( result != CY_RSLT_SUCCESS )
         {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nQoS not supported..!\n" );
-            free( sub_list );
-            return CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
+            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nJoin MQTT reconnect thread failed with Error : [0x%X] ", (unsigned int)result );
+            /* Fall-through. */
         }
-        sub_info[ index ].allocated_qos = CY_MQTT_QOS_INVALID;
-        sub_list[ index ].pTopicFilter = sub_info[index].topic;
-        sub_list[ index ].topicFilterLength = sub_info[index].topic_len;
+        mqtt_obj->reconnect_thread = NULL;
     }
 
-    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+    mqtt_cleanup_tracked_subscriptions( mqtt_obj );
+    mqtt_filter_free( &(mqtt_obj->filter_trie) );
+    mqtt_cleanup_coalesce_table( mqtt_obj );
+    (void)cy_rtos_deinit_mutex( &(mqtt_obj->process_mutex) );
+    (void)cy_rtos_deinit_mutex( &(mqtt_obj->flow_mutex) );
+    (void)cy_rtos_deinit_mutex( &(mqtt_obj->coalesce_mutex) );
+    (void)cy_rtos_deinit_event( &(mqtt_obj->priority_event) );
+
+    result = cy_rtos_get_mutex( &mqtt_db_mutex, CY_RTOS_NEVER_TIMEOUT );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
-        free( sub_list );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
         return result;
     }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_delete - Acquired Mutex %p ", mqtt_db_mutex );
 
-    /* Generate the packet identifier for the SUBSCRIBE packet. */
-    mqtt_obj->sent_packet_id = MQTT_GetPacketId( &(mqtt_obj->mqtt_context) );
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_subscribe - Acquired Mutex %p ", mqtt_obj->process_mutex );
+    /* Clear entry in THE MQTT object-mqtt context table. */
+    mqtt_handle_database[mqtt_obj->mqtt_obj_index].mqtt_handle = NULL;
+    mqtt_handle_database[mqtt_obj->mqtt_obj_index].mqtt_context = NULL;
+    mqtt_handle_count--;
 
-    do
+    result = cy_rtos_set_mutex( &mqtt_db_mutex );
+    if( result != CY_RSLT_SUCCESS )
     {
-        timeout = CY_MQTT_ACK_RECEIVE_TIMEOUT_MS;
-        result = CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
-        memset( &mqtt_obj->sub_ack_status, 0x00, sizeof(mqtt_obj->sub_ack_status) );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
+        return result;
+    }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_delete - Released Mutex %p ", mqtt_db_mutex );
 
-        /*
-         * num_of_subs_in_req is initialized with number of subscribe messages in one MQTT subscribe request.
-         * Once after receiving the subscription acknowledgment this variable is set to zero.
-         * So num_of_subs_in_req == 0 refers that there is no outstanding subscription messages waiting for acknowledgment. */
-        mqtt_obj->num_of_subs_in_req = sub_count;
+    /* Clear the MQTT handle info. */
+    ( void ) memset( mqtt_obj, 0x00, sizeof( cy_mqtt_object_t ) );
 
-        /* Send the SUBSCRIBE packet. */
-        mqttStatus = MQTT_Subscribe( &(mqtt_obj->mqtt_context),
-                                     sub_list,
-                                     sub_count,
-                                     mqtt_obj->sent_packet_id );
-        if( mqttStatus != MQTTSuccess )
-        {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nFailed to send SUBSCRIBE packet to broker with error = %s.",
-                             MQTT_Status_strerror( mqttStatus ) );
-            result = CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
-        }
-        else
-        {
-            for( index = 0; index < sub_count; index++ )
-            {
-                mqtt_obj->sub_ack_status[index] = MQTTSubAckFailure;
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nSUBSCRIBE sent for topic %.*s to broker.\n",
-                                 sub_list[ index ].topicFilterLength,
-                                 sub_list[ index ].pTopicFilter );
-            }
-            do
-            {
-                /* Process the incoming packet from the broker.
-                 * Acknowledgment for subscription ( SUBACK ) will be received here. */
-                mqttStatus = MQTT_ProcessLoop( &(mqtt_obj->mqtt_context), CY_MQTT_RECEIVE_DATA_TIMEOUT_MS );
-                if( mqttStatus != MQTTSuccess )
-                {
-                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT_ProcessLoop returned with status = %s.", MQTT_Status_strerror( mqttStatus ) );
-                    result = CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
-                    break;
-                }
+    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\n Free mqtt_obj : %p..!\n", mqtt_obj );
+    free( mqtt_obj );
+    mqtt_handle = NULL;
 
-                /* if suback status is updated then num_of_subs_in_req will be set to 0 in mqtt_event_callback.*/
-                if( mqtt_obj->num_of_subs_in_req == 0 )
-                {
-                    result = CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL; /* Initialize result with failure. */
-                    for( index = 0; index < sub_count; index++ )
-                    {
-                        if( mqtt_obj->sub_ack_status[index] == MQTTSubAckFailure )
-                        {
-                            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nMQTT broker rejected SUBSCRIBE request for topic %.*s .\n",
-                                             sub_list[ index ].topicFilterLength,
-                                             sub_list[ index ].pTopicFilter );
-                            sub_info[ index ].allocated_qos = CY_MQTT_QOS_INVALID;
-                        }
-                        else
-                        {
-                            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nSUBSCRIBE accepted for topic %.*s with QoS %d .\n",
-                                             sub_list[ index ].topicFilterLength,
-                                             sub_list[ index ].pTopicFilter, mqtt_obj->sub_ack_status[index] );
-                            if( mqtt_obj->sub_ack_status[index] == MQTTSubAckSuccessQos0 )
-                            {
-                                sub_info[ index ].allocated_qos = CY_MQTT_QOS0;
-                            }
-                            else if( mqtt_obj->sub_ack_status[index] == MQTTSubAckSuccessQos1 )
-                            {
-                                sub_info[ index ].allocated_qos = CY_MQTT_QOS1;
-                            }
-                            else
-                            {
-                                sub_info[ index ].allocated_qos = CY_MQTT_QOS2;
-                            }
-                            result = CY_RSLT_SUCCESS; /* Update with success if at least one subscription is successful. */
-                        }
-                    }
-                    break; /* Received the ack. So exit timeout do loop */
-                }
-                timeout = timeout - CY_MQTT_SOCKET_RECEIVE_TIMEOUT_MS;
-            } while( timeout > 0 );
+    return CY_RSLT_SUCCESS;
+}
 
-            if( mqtt_obj->num_of_subs_in_req != 0 )
-            {
-                result = CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
-                mqttStatus = MQTTRecvFailed; /* Assign error value to retry subscribe. */
-            }
-        }
-        retry++;
-    } while( (mqttStatus != MQTTSuccess) && (retry < CY_MQTT_MAX_RETRY_VALUE) );
+/*----------------------------------------------------------------------------------------------------------*/
 
+cy_rslt_t cy_mqtt_get_config( cy_mqtt_t mqtt_handle, cy_mqtt_config_t *config )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t  *mqtt_obj;
+
+    if( (mqtt_handle == NULL) || (config == NULL) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_get_config()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+    }
+
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nSubscription ack status is MQTTSubAckFailure..!\n" );
-        goto exit;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return result;
     }
 
+    memcpy( config, &(mqtt_obj->config), sizeof(cy_mqtt_config_t) );
+
     result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
-        free( sub_list );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
         return result;
     }
 
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_subscribe - Released Mutex %p ", mqtt_obj->process_mutex );
-    free( sub_list );
     return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_set_config( cy_mqtt_t mqtt_handle, const cy_mqtt_config_t *config )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t  *mqtt_obj;
+
+    if( (mqtt_handle == NULL) || (config == NULL) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_set_config()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    if( (config->ack_receive_timeout_ms == 0) || (config->message_send_timeout_ms == 0) ||
+        (config->message_receive_timeout_ms == 0) || (config->max_retry_value == 0) ||
+        (config->receive_thread_sleep_ms == 0) || (config->receive_thread_stack_size == 0) ||
+        ((config->ack_timeout_max_ms != 0) &&
+         ((config->ack_timeout_min_ms == 0) || (config->ack_timeout_min_ms > config->ack_timeout_max_ms))) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT configuration..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+    }
+
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return result;
+    }
+
+    memcpy( &(mqtt_obj->config), config, sizeof(cy_mqtt_config_t) );
+
+    /* Re-derive the acknowledgment timeout under the new bounds from the current estimate. */
+    if( mqtt_obj->rtt.valid == false )
+    {
+        mqtt_obj->rtt.rto_ms = config->ack_receive_timeout_ms;
+    }
+    else if( config->ack_timeout_max_ms != 0 )
+    {
+        mqtt_obj->rtt.rto_ms = mqtt_rtt_clamp( mqtt_obj, mqtt_obj->rtt.rto_ms );
+    }
+
+    if( (mqtt_obj->rate_limiter.msgs_per_sec != config->rate_limit_msgs_per_sec) ||
+        (mqtt_obj->rate_limiter.bytes_per_sec != config->rate_limit_bytes_per_sec) )
+    {
+        if( cy_rtos_get_mutex( &(mqtt_obj->flow_mutex), CY_RTOS_NEVER_TIMEOUT ) == CY_RSLT_SUCCESS )
+        {
+            mqtt_rate_reset( mqtt_obj );
+            (void)cy_rtos_set_mutex( &(mqtt_obj->flow_mutex) );
+        }
+    }
 
-exit :
-    (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
-    /* Free sub_list */
-    if( sub_list != NULL )
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
     {
-        free( sub_list );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return result;
     }
 
-    return result;
+    return CY_RSLT_SUCCESS;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-cy_rslt_t cy_mqtt_unsubscribe( cy_mqtt_t mqtt_handle, cy_mqtt_unsubscribe_info_t *unsub_info, uint8_t unsub_count )
+cy_rslt_t cy_mqtt_enable_auto_reconnect( cy_mqtt_t mqtt_handle, bool enable )
 {
-    cy_rslt_t              result = CY_RSLT_SUCCESS;
-    cy_mqtt_object_t       *mqtt_obj;
-    MQTTStatus_t           mqttStatus;
-    uint8_t                index = 0, retry = 0;
-    MQTTSubscribeInfo_t    *unsub_list = NULL;
-    uint32_t               timeout = 0;
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t  *mqtt_obj;
 
-    if( (mqtt_handle == NULL) || (unsub_info == NULL) || (unsub_count < 1) )
+    if( mqtt_handle == NULL )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_unsubscribe()..!\n" );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_enable_auto_reconnect()..!\n" );
         return CY_RSLT_MODULE_MQTT_BADARG;
     }
 
@@ -1789,255 +5306,190 @@ cy_rslt_t cy_mqtt_unsubscribe( cy_mqtt_t mqtt_handle, cy_mqtt_unsubscribe_info_t
         return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
     }
 
-    if( mqtt_obj->mqtt_session_established == false )
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
+    if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client session not present..!\n" );
-        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return result;
     }
 
-    if( unsub_count > CY_MQTT_MAX_OUTGOING_SUBSCRIBES )
+    mqtt_obj->auto_reconnect = enable;
+    if( enable == false )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMax number of supported unsubscription count in single request is %d\n", (int)CY_MQTT_MAX_OUTGOING_SUBSCRIBES );
-        return CY_RSLT_MODULE_MQTT_UNSUBSCRIBE_FAIL;
+        mqtt_cleanup_tracked_subscriptions( mqtt_obj );
     }
 
-    unsub_list = (MQTTSubscribeInfo_t *)malloc( (sizeof(MQTTSubscribeInfo_t) * unsub_count) );
-    if( unsub_list == NULL )
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMemory not available to create unsub_list..!\n" );
-        return CY_RSLT_MODULE_MQTT_NOMEM;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return result;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nsub_list : %p..!\n", unsub_list );
 
-    for( index = 0; index < unsub_count; index++ )
+    return CY_RSLT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+
+cy_rslt_t cy_mqtt_set_codec( cy_mqtt_t mqtt_handle, const cy_mqtt_codec_t *codec )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_mqtt_object_t  *mqtt_obj;
+
+    if( mqtt_handle == NULL )
     {
-        if( unsub_info[index].qos == CY_MQTT_QOS0 )
-        {
-            unsub_list[ index ].qos = MQTTQoS0;
-        }
-        else if( unsub_info[index].qos == CY_MQTT_QOS1 )
-        {
-            unsub_list[ index ].qos = MQTTQoS1;
-        }
-        else if( unsub_info[index].qos == CY_MQTT_QOS2 )
-        {
-            unsub_list[ index ].qos = MQTTQoS2;
-        }
-        else
-        {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nQoS level not supported...\n" );
-            free( unsub_list );
-            return CY_RSLT_MODULE_MQTT_UNSUBSCRIBE_FAIL;
-        }
-        unsub_list[ index ].pTopicFilter = unsub_info[index].topic;
-        unsub_list[ index ].topicFilterLength = unsub_info[index].topic_len;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_set_codec()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+    }
+
+    if( (codec != NULL) && (codec->release == NULL) && ((codec->encode != NULL) || (codec->decode != NULL)) )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nCodec release function is required..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
     }
 
     result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
     if( result != CY_RSLT_SUCCESS )
     {
         cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
-        free( unsub_list );
         return result;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_unsubscribe - Acquired Mutex %p ", mqtt_obj->process_mutex );
-
-    /* Generate the packet identifier for the UNSUBSCRIBE packet. */
-    mqtt_obj->sent_packet_id = MQTT_GetPacketId( &(mqtt_obj->mqtt_context) );
 
-    do
+    /* Publishes encode outside the process mutex, so the codec can only be changed while disconnected. */
+    if( mqtt_obj->mqtt_conn_status == true )
     {
-        timeout = CY_MQTT_ACK_RECEIVE_TIMEOUT_MS;
-        mqtt_obj->unsub_ack_received = false;
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "UNSUBSCRIBE sent for topic %.*s to broker.\n\n", unsub_info->topic_len, unsub_info->topic );
-        /* Send the UNSUBSCRIBE packet. */
-        mqttStatus = MQTT_Unsubscribe( &(mqtt_obj->mqtt_context),
-                                       unsub_list,
-                                       unsub_count,
-                                       mqtt_obj->sent_packet_id );
-        if( mqttStatus != MQTTSuccess )
-        {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "Failed to send UNSUBSCRIBE packet to broker with error = %s.",
-                        MQTT_Status_strerror( mqttStatus ) );
-            result = CY_RSLT_MODULE_MQTT_UNSUBSCRIBE_FAIL;
-        }
-        else
-        {
-            do
-            {
-                /* Process the  incoming packet from the broker.
-                 * Acknowledgment for UNSUBSCRIBE ( UNSUBACK ) will be received here. */
-                mqttStatus = MQTT_ProcessLoop( &(mqtt_obj->mqtt_context), CY_MQTT_RECEIVE_DATA_TIMEOUT_MS );
-                if( mqttStatus != MQTTSuccess )
-                {
-                    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT_ProcessLoop returned with status = %s.", MQTT_Status_strerror( mqttStatus ) );
-                    result = CY_RSLT_MODULE_MQTT_UNSUBSCRIBE_FAIL;
-                    break;
-                }
-                if( mqtt_obj->unsub_ack_received == true )
-                {
-                    result = CY_RSLT_SUCCESS;
-                    break;
-                }
-                timeout = timeout - CY_MQTT_SOCKET_RECEIVE_TIMEOUT_MS;
-            } while( timeout > 0 );
-
-            if( mqtt_obj->unsub_ack_received == false )
-            {
-                cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nNot received unsuback before timeout %u millisecond ", (unsigned int)CY_MQTT_ACK_RECEIVE_TIMEOUT_MS );
-                result = CY_RSLT_MODULE_MQTT_UNSUBSCRIBE_FAIL;
-                mqttStatus = MQTTRecvFailed; /* Assign error value to retry subscribe. */
-            }
-        }
-        retry++;
-    } while( (mqttStatus != MQTTSuccess) && (retry < CY_MQTT_MAX_RETRY_VALUE) );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client is connected. Set the codec before cy_mqtt_connect..!\n" );
+        (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+        return CY_RSLT_MODULE_MQTT_ALREADY_CONNECTED;
+    }
 
-    if( result != CY_RSLT_SUCCESS )
+    if( codec == NULL )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_INFO, "\nSubscription ack status is MQTTSubAckFailure..!\n" );
-        goto exit;
+        memset( &(mqtt_obj->codec), 0x00, sizeof( cy_mqtt_codec_t ) );
+    }
+    else
+    {
+        mqtt_obj->codec = *codec;
     }
 
     result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
-        free( unsub_list );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
         return result;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_unsubscribe - Released Mutex %p ", mqtt_obj->process_mutex );
 
-    /* Free unsub_list. */
-    free( unsub_list );
     return CY_RSLT_SUCCESS;
-
-exit :
-    (void)cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
-    /* Free unsub_list. */
-    if( unsub_list != NULL )
-    {
-        free( unsub_list );
-    }
-
-    return result;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-cy_rslt_t cy_mqtt_disconnect( cy_mqtt_t mqtt_handle )
+cy_rslt_t cy_mqtt_register_subscription_callback( cy_mqtt_t mqtt_handle, const char *topic_filter, uint16_t filter_len,
+                                                  cy_mqtt_callback_t callback, void *user_data )
 {
     cy_rslt_t         result = CY_RSLT_SUCCESS;
+    cy_rslt_t         add_result = CY_RSLT_SUCCESS;
     cy_mqtt_object_t  *mqtt_obj;
-    MQTTStatus_t mqttStatus = MQTTSuccess;
 
-    if( mqtt_handle == NULL )
+    if( (mqtt_handle == NULL) || (topic_filter == NULL) || (filter_len == 0) || (callback == NULL) )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_disconnect()..!\n" );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_register_subscription_callback()..!\n" );
         return CY_RSLT_MODULE_MQTT_BADARG;
     }
 
     mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
+    }
+
+    if( mqtt_validate_topic_filter( topic_filter, filter_len ) == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid topic filter %.*s..!\n", filter_len, topic_filter );
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
 
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_disconnect - Acquiring Mutex %p ", mqtt_obj->process_mutex );
     result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
     if( result != CY_RSLT_SUCCESS )
     {
         cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
         return result;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_disconnect - Acquired Mutex %p ", mqtt_obj->process_mutex );
 
-    if( mqtt_obj->mqtt_obj_initialized == false )
-    {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
-        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
-    }
+    add_result = mqtt_filter_insert( mqtt_obj, topic_filter, filter_len, callback, user_data );
 
-    if( mqtt_obj->mqtt_conn_status == false )
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nMQTT client not connected..!\n" );
-        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
     }
 
-    if( mqtt_obj->recv_thread != NULL )
-    {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nTerminating MQTT receive thread %p..!\n", mqtt_obj->recv_thread );
-        result = cy_rtos_terminate_thread( &mqtt_obj->recv_thread  );
-        if( result != CY_RSLT_SUCCESS )
-        {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nTerminate MQTT receive thread failed with Error : [0x%X] ", (unsigned int)result );
-            return result;
-        }
+    return ( (add_result != CY_RSLT_SUCCESS) ? add_result : result );
+}
 
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\nJoining MQTT receive thread %p..!\n", mqtt_obj->recv_thread );
-        result = cy_rtos_join_thread( &mqtt_obj->recv_thread );
-        if( result != CY_RSLT_SUCCESS )
-        {
-            cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nJoin MQTT receive thread failed with Error : [0x%X] ", (unsigned int)result );
-            return result;
-        }
-        mqtt_obj->recv_thread = NULL;
-    }
+/*----------------------------------------------------------------------------------------------------------*/
 
-    /* Send DISCONNECT. */
-    mqttStatus = MQTT_Disconnect( &(mqtt_obj->mqtt_context) );
-    if( mqttStatus != MQTTSuccess )
+cy_rslt_t cy_mqtt_deregister_subscription_callback( cy_mqtt_t mqtt_handle, const char *topic_filter, uint16_t filter_len )
+{
+    cy_rslt_t         result = CY_RSLT_SUCCESS;
+    bool              removed = false;
+    cy_mqtt_object_t  *mqtt_obj;
+
+    if( (mqtt_handle == NULL) || (topic_filter == NULL) || (filter_len == 0) )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "Sending MQTT DISCONNECT failed with status=%s.",
-                         MQTT_Status_strerror( mqttStatus ) );
-        /*
-         * In case of an unexpected network disconnection, the MQTT_Disconnect API always returns failure. Therefore,
-         * the return value of the MQTT_Disconnect API is not checked here.
-         */
-        /* Fall-through. */
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_deregister_subscription_callback()..!\n" );
+        return CY_RSLT_MODULE_MQTT_BADARG;
     }
 
-    mqtt_obj->mqtt_session_established = false;
-    result = cy_awsport_network_disconnect( &(mqtt_obj->network_context) );
-    if( result != CY_RSLT_SUCCESS )
+    mqtt_obj = (cy_mqtt_object_t *)mqtt_handle;
+    if( mqtt_obj->mqtt_obj_initialized == false )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_awsport_network_disconnect failed with Error : [0x%X] ", (unsigned int)result );
-        /*
-         * In case of an unexpected network disconnection, the cy_awsport_network_disconnect API always returns failure. Therefore,
-         * the return value of the cy_awsport_network_disconnect API is not checked here.
-         */
-        /* Fall-through. */
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nInvalid MQTT object..!\n" );
+        return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
     }
 
-    result = cy_awsport_network_delete( &(mqtt_obj->network_context) );
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_awsport_network_delete failed with Error : [0x%X] ", (unsigned int)result );
-        /*
-         * In case of an unexpected network disconnection, the cy_awsport_network_delete API always returns failure. Therefore,
-         * the return value of the cy_awsport_network_delete API is not checked here.
-         */
-        /* Fall-through. */
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return result;
     }
-    mqtt_obj->mqtt_conn_status = false;
 
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_disconnect - Releasing Mutex %p ", mqtt_obj->process_mutex );
+    removed = mqtt_filter_remove( &(mqtt_obj->filter_trie), topic_filter, filter_len );
+
     result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", (unsigned int)result );
-        return result;
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+    }
+
+    if( removed == false )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nNo callback registered for topic filter %.*s..!\n", filter_len, topic_filter );
+        return CY_RSLT_MODULE_MQTT_BADARG;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_disconnect - Released Mutex %p ", mqtt_obj->process_mutex );
 
     return result;
 }
 
 /*----------------------------------------------------------------------------------------------------------*/
 
-cy_rslt_t cy_mqtt_delete( cy_mqtt_t mqtt_handle )
+cy_rslt_t cy_mqtt_get_stats( cy_mqtt_t mqtt_handle, cy_mqtt_stats_t *stats )
 {
     cy_rslt_t         result = CY_RSLT_SUCCESS;
     cy_mqtt_object_t  *mqtt_obj;
 
-    if( mqtt_handle == NULL )
+    if( (mqtt_handle == NULL) || (stats == NULL) )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_delete()..!\n" );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\nBad arguments to cy_mqtt_get_stats()..!\n" );
         return CY_RSLT_MODULE_MQTT_BADARG;
     }
 
@@ -2048,35 +5500,37 @@ cy_rslt_t cy_mqtt_delete( cy_mqtt_t mqtt_handle )
         return CY_RSLT_MODULE_MQTT_OBJ_NOT_INITIALIZED;
     }
 
-    (void)cy_rtos_deinit_mutex( &(mqtt_obj->process_mutex) );
-
-    result = cy_rtos_get_mutex( &mqtt_db_mutex, CY_RTOS_NEVER_TIMEOUT );
+    result = cy_rtos_get_mutex( &(mqtt_obj->process_mutex), CY_RTOS_NEVER_TIMEOUT );
     if( result != CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_get_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
         return result;
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_delete - Acquired Mutex %p ", mqtt_db_mutex );
 
-    /* Clear entry in THE MQTT object-mqtt context table. */
-    mqtt_handle_database[mqtt_obj->mqtt_obj_index].mqtt_handle = NULL;
-    mqtt_handle_database[mqtt_obj->mqtt_obj_index].mqtt_context = NULL;
-    mqtt_handle_count--;
+    memcpy( stats, &(mqtt_obj->stats), sizeof(cy_mqtt_stats_t) );
 
-    result = cy_rtos_set_mutex( &mqtt_db_mutex );
-    if( result != CY_RSLT_SUCCESS )
+    /* The rate limit and coalescing counters live under their own mutexes, which nest inside process_mutex. */
+    if( cy_rtos_get_mutex( &(mqtt_obj->flow_mutex), CY_RTOS_NEVER_TIMEOUT ) == CY_RSLT_SUCCESS )
     {
-        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_db_mutex, (unsigned int)result );
-        return result;
+        stats->rate_limited_count = mqtt_obj->rate_limiter.refused_count;
+        (void)cy_rtos_set_mutex( &(mqtt_obj->flow_mutex) );
+    }
+    if( cy_rtos_get_mutex( &(mqtt_obj->coalesce_mutex), CY_RTOS_NEVER_TIMEOUT ) == CY_RSLT_SUCCESS )
+    {
+        stats->coalesced_count = mqtt_obj->coalesced_count;
+        (void)cy_rtos_set_mutex( &(mqtt_obj->coalesce_mutex) );
     }
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\ncy_mqtt_delete - Released Mutex %p ", mqtt_db_mutex );
 
-    /* Clear the MQTT handle info. */
-    ( void ) memset( mqtt_obj, 0x00, sizeof( cy_mqtt_object_t ) );
+    stats->srtt_ms = mqtt_obj->rtt.srtt_ms;
+    stats->rttvar_ms = mqtt_obj->rtt.rttvar_ms;
+    stats->ack_timeout_ms = mqtt_ack_timeout( mqtt_obj );
 
-    cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_DEBUG, "\n Free mqtt_obj : %p..!\n", mqtt_obj );
-    free( mqtt_obj );
-    mqtt_handle = NULL;
+    result = cy_rtos_set_mutex( &(mqtt_obj->process_mutex) );
+    if( result != CY_RSLT_SUCCESS )
+    {
+        cy_mqtt_log_msg( CYLF_MIDDLEWARE, CY_LOG_ERR, "\ncy_rtos_set_mutex for Mutex %p failed with Error : [0x%X] ", mqtt_obj->process_mutex, (unsigned int)result );
+        return result;
+    }
 
     return CY_RSLT_SUCCESS;
 }